@@ -1,27 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
+#include <exception>
+#include <future>
+#include <getopt.h>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
 #include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include "days/day0.h"
-#include "days/day1.h"
-#include "days/day2.h"
-#include "days/day3.h"
-#include "days/day4.h"
-#include "days/day5.h"
-#include "days/day6.h"
-#include "days/day7.h"
-#include "days/day8.h"
+#include "days/days.h"
+#include "gen/inputs.h"
+#include "util/alloc_counter.h"
+#include "util/arena.h"
+#include "util/binary_cache.h"
+#include "util/cpu_dispatch.h"
+#include "util/engine.h"
+#include "util/footprint.h"
+#include "util/hash.h"
+#include "util/line_index.h"
+#include "util/lru_cache.h"
+#include "util/mapped_file.h"
+#include "util/parallel.h"
+#include "util/perf_counters.h"
+#include "util/ring_buffer.h"
+#include "util/serialize.h"
+#include "util/thread_pool.h"
+#include "util/timing.h"
+#include "util/trace.h"
 using namespace aoc;
 
-#define OPTSTRING "hd:p:"
-#define HELP_MESSAGE                                                  \
-    "[ -h ] | -d DAY [ -p PART ] INPUT_FILE\n\n"                      \
-    "INPUT_FILE is a path to a file containing the puzzle input.\n\n" \
-    "    -h      display this help message and exit\n"                \
-    "    -d DAY  which day [0-25] to run\n"                           \
-    "    -p PART which part [1-2] to run, leave unspecified for both parts"
+#define OPTSTRING "hd:p:b:f:ct:C:rM:a:l:S:m:j:"
+
+// Options that only have a long name, numbered past every char so as not to clash with the short ones
+enum long_option {
+    WatchOption = 256,
+    EngineOption,
+    CrossCheckOption,
+    TuneOption,
+    ScalingOption,
+    ThreadScalingOption,
+};
+
+static const option LONG_OPTIONS[] = {
+    {"watch", no_argument, nullptr, WatchOption},
+    {"engine", required_argument, nullptr, EngineOption},
+    {"cross-check", no_argument, nullptr, CrossCheckOption},
+    {"tune", no_argument, nullptr, TuneOption},
+    {"scaling", no_argument, nullptr, ScalingOption},
+    {"thread-scaling", no_argument, nullptr, ThreadScalingOption},
+    {nullptr, 0, nullptr, 0},
+};
+
+#define HELP_MESSAGE                                                                                    \
+    "[ -h ] | -d DAY [ -p PART ] [ -c ] [ -t TRACE_FILE ] [ -C DIR [ -r ] ] [ -M DIR [ -a MODE ] ]\n"   \
+    "         [ -l FILE ] [ -j N ] [ -b N [ -f FORMAT ] ] [ --engine=NAME ] [ --cross-check ]\n"        \
+    "         [ --watch | --tune ] INPUT_FILE...\n"                                                     \
+    "       | -d DAY [ -p PART ] [ -j N ] [ --engine=NAME ] --scaling | --thread-scaling\n"             \
+    "       | -S SOCKET [ -m BYTES ]\n\n"                                                               \
+    "INPUT_FILE is a path to a file containing the puzzle input. If DAY is all then it is\n"            \
+    "instead a directory containing a dayN-input.txt file for each day. Given several input\n"          \
+    "files, or a list of them with -l, the day is run on all of them in parallel and their\n"           \
+    "answers are printed one line per file. If INPUT_FILE is - the input is streamed from\n"            \
+    "stdin a chunk at a time, in constant memory, which only works for the days whose\n"                \
+    "answers can be worked out a piece at a time: 2 and 7 a line at a time, and 0 a few\n"              \
+    "numbers at a time.\n\n"                                                                            \
+    "    -h        display this help message and exit\n"                                                \
+    "    -d DAY    which day [0-25] to run, or all to run every day at once\n"                          \
+    "    -p PART   which part [1-2] to run, leave unspecified for both parts\n"                         \
+    "    -c        print hardware performance counters for each phase after the answers; the\n"         \
+    "              phases then run on one thread, as the counters only see the one\n"                   \
+    "    -t FILE   write a Chrome trace of the run to FILE (needs a -DAOC_TRACING=ON build)\n"          \
+    "    -C DIR    cache parsed inputs in DIR, keyed by their contents, and load them from there\n"     \
+    "              instead of parsing the text when they haven't changed\n"                             \
+    "    -r        parse inputs afresh and rewrite their cache entries even if they look current\n"     \
+    "    -M DIR    remember answers in DIR, keyed by the input and this build of the program, and\n"    \
+    "              print remembered answers instead of working them out again\n"                        \
+    "    -a MODE   what to do with remembered answers: use them (the default), bypass them,\n"          \
+    "              verify them by working them out again and comparing, or clear them all and exit\n"   \
+    "    -l FILE   also run the day on every input file listed in FILE, one path per line\n"            \
+    "    -j N      run days, input files and the loops within a day on pools of N threads\n"            \
+    "              (default: one thread per hardware thread)\n"                                         \
+    "    -b N      benchmark the day: time each phase N times after a short warmup and\n"               \
+    "              report the min, median and 99th percentile instead of the answers\n"                 \
+    "    -f FORMAT how to print benchmark results: text (the default), json or csv\n"                   \
+    "    --watch   run the day again every time the input file changes, until interrupted; days\n"      \
+    "              0, 2 and 7 only work out the answers for lines that are new or changed\n"            \
+    "    --engine=NAME  which implementation to use for the parts that have several: reference,\n"      \
+    "              serial, parallel, or auto (the default) to pick one by the size of the input\n"      \
+    "    --cross-check  work out every answer again with the reference engine, and fail if the\n"       \
+    "              two don't match\n"                                                                   \
+    "    --tune    time every engine of the day's parts on each input file and suggest the input\n"     \
+    "              sizes from which auto should pick each one\n"                                        \
+    "    --scaling time the day on generated inputs of growing sizes instead of on input files,\n"      \
+    "              and print the exponent of the input size each phase's time grows by and\n"           \
+    "              how well it fits\n"                                                                  \
+    "    --thread-scaling  time the day on generated inputs with 1, 2, 4 and so on up to N\n"           \
+    "              threads, both on one input and on inputs that grow with the number of threads,\n"    \
+    "              and print the speedups and the time spent waiting for the slowest thread\n"          \
+    "\n"                                                                                                \
+    "Alternatively, -S SOCKET [ -m BYTES ] runs as a server instead. It answers requests of the form\n" \
+    "\"DAY PART PATH\" (PART is 1, 2 or both), one per line, on the Unix domain socket SOCKET or on\n"  \
+    "stdin if SOCKET is -, and keeps parsed inputs cached between requests.\n\n"                        \
+    "    -S SOCKET where to listen for requests\n"                                                      \
+    "    -m BYTES  roughly how much memory the cache of parsed inputs may use, with an optional K,\n"   \
+    "              M or G suffix (default 1G)\n\n"                                                      \
+    "The vectorised parts of some days use the best instructions the CPU has (up to AVX-512).\n"        \
+    "Set AOC_CPU_LEVEL to scalar, sse2, sse4.2, avx2 or avx512 to use no better than that."
+
+// Sentinel value of the day option meaning every day in the registry
+#define ALL_DAYS (-2L)
 
 enum class Part {
     BothParts,
@@ -29,102 +142,1559 @@ enum class Part {
     Part2
 };
 
+enum class Format {
+    Text,
+    Json,
+    Csv
+};
+
 static void usage(const char *progname, int exit_code) {
     std::cout << "usage: " << progname << ' ' << HELP_MESSAGE << std::endl;
     std::exit(exit_code);
 }
 
-static int run_aoc(const long day, const Part part, std::ifstream &input) {
+// Per-phase measurements for a normal run: hardware counters if asked for with -c, and heap usage if the binary was
+// built with allocation counting. Both only see the thread they are started on, so phases are measured with their
+// parallel loops on a pool of one (see pool_scope), which leaves the calling thread to run every chunk itself.
+class phase_probe {
+    struct phase {
+        const char *name;
+        perf_counters::sample counters;
+        alloc_stats allocs;
+    };
+
+    std::optional<perf_counters> counters;
+    std::vector<phase> phases;
+    thread_pool one_thread{1};
+
+public:
+    explicit phase_probe(bool hw_counters) {
+        if (hw_counters)
+            counters.emplace();
+    }
+
+    template <class F>
+    auto measure(const char *name, F &&f) {
+        const pool_scope scope{one_thread};
+        alloc_counter allocs;
+        stopwatch sw;
+        allocs.start();
+        if (counters)
+            counters->start();
+        auto result = f();
+        phase p{name, counters ? counters->stop() : perf_counters::sample{}, allocs.stop()};
+        if (!counters)
+            p.counters.ns = sw.elapsed_ns();
+        phases.push_back(p);
+        return result;
+    }
+
+    void report(std::ostream &out) const {
+        const auto hw = counters && counters->available();
+        if (counters && !hw)
+            out << "note: hardware counters unavailable (" << counters->error()
+                << "), falling back to wall-clock timing\n";
+
+        out << std::left << std::setw(8) << "phase" << std::right << std::setw(14) << "wall (us)";
+        if (hw) {
+            for (auto e = 0; e < perf_counters::NumEvents; e++)
+                out << std::setw(15) << perf_counters::name(static_cast<perf_counters::event>(e));
+            out << std::setw(8) << "IPC";
+        }
+        if (alloc_counter::enabled)
+            out << std::setw(14) << "allocations" << std::setw(14) << "bytes" << std::setw(14) << "peak bytes";
+        out << '\n';
+
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        for (const auto &p : phases) {
+            out << std::left << std::setw(8) << p.name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(14) << p.counters.ns / 1000;
+            if (hw) {
+                for (const auto &count : p.counters.counts) {
+                    if (count)
+                        out << std::setw(15) << *count;
+                    else
+                        out << std::setw(15) << '-';
+                }
+                const auto &cycles = p.counters.counts[perf_counters::Cycles],
+                           &instructions = p.counters.counts[perf_counters::Instructions];
+                if (cycles && instructions && *cycles)
+                    out << std::setw(8) << std::setprecision(2) << static_cast<double>(*instructions) / *cycles;
+                else
+                    out << std::setw(8) << '-';
+            }
+            if (alloc_counter::enabled)
+                out << std::setw(14) << p.allocs.allocations << std::setw(14) << p.allocs.bytes << std::setw(14)
+                    << p.allocs.peak_bytes;
+            out << '\n';
+        }
+        out.flags(flags);
+        out.precision(precision);
+        out.flush();
+    }
+};
+
+template <class F>
+static auto measure(phase_probe *probe, const char *phase, F &&f) {
+    AOC_TRACE_SCOPE(phase);
+    if (!probe)
+        return f();
+    return probe->measure(phase, std::forward<F>(f));
+}
+
+// Where parsed inputs are cached between runs (-C), and whether to ignore what's already there (-r)
+struct parse_cache {
+    binary_cache entries;
+    bool rebuild;
+};
+
+// Parses input, or loads it from cache if the same text has been parsed before. Stale or corrupt entries are parsed
+// afresh and overwritten.
+template <class Day>
+static typename Day::input_type parse(std::string_view input, const parse_cache *cache) {
+    using Input = typename Day::input_type;
+
+    // Days that parse to a view of the text have nothing worth saving
+    if constexpr (std::is_same_v<Input, std::string_view>) {
+        return Day::parse(input);
+    } else {
+        if (!cache)
+            return Day::parse(input);
+
+        const cache_key key{static_cast<std::uint64_t>(Day::number),
+                            hash_bytes(typeid(Input).name(), std::strlen(typeid(Input).name()), input_schema_version),
+                            hash_bytes(input), input.size()};
+        if (!cache->rebuild) {
+            std::string_view payload;
+            if (const auto file = cache->entries.load(key, payload)) {
+                try {
+                    byte_reader r{payload};
+                    auto input_parsed = deserialize(r, type_tag<Input>{});
+                    if (r.remaining() == 0)
+                        return input_parsed;
+                } catch (const std::runtime_error &) {
+                    // The checksum matched but the contents don't decode, so parse it again below
+                }
+            }
+        }
+
+        auto input_parsed = Day::parse(input);
+        byte_writer w;
+        serialize(w, input_parsed);
+        cache->entries.store(key, w.view()); // best effort: a cache we can't write to just means parsing next time
+        return input_parsed;
+    }
+}
+
+enum class MemoMode {
+    Use,
+    Bypass,
+    Verify,
+    Clear,
+};
+
+// Where answers are remembered between runs (-M), and what to do with them (-a). Answers are keyed by a hash of the
+// executable as well as of the input, so that rebuilding after changing a solution never brings back its old answers.
+struct answer_memo {
+    binary_cache part1, part2;
+    std::uint64_t build;
+    MemoMode mode;
+};
+
+// Returns the answer to part number n remembered for input, if any, or else works it out with solve() and remembers
+// it. In verify mode the answer is always worked out, and it is an error for it to differ from the one remembered.
+template <class Day, int N, class F>
+static auto memoized(const answer_memo *memo, std::string_view input, F &&solve) {
+    if (!memo || memo->mode == MemoMode::Bypass)
+        return solve();
+
+    using Output = decltype(solve());
+    const auto &store = N == 1 ? memo->part1 : memo->part2;
+    const cache_key key{static_cast<std::uint64_t>(Day::number),
+                        hash_bytes(typeid(Output).name(), std::strlen(typeid(Output).name()), memo->build),
+                        hash_bytes(input), input.size()};
+
+    std::optional<Output> known;
+    std::string_view payload;
+    if (const auto file = store.load(key, payload)) {
+        try {
+            byte_reader r{payload};
+            known = deserialize(r, type_tag<Output>{});
+        } catch (const std::runtime_error &) {
+            // Treat it as missing and overwrite it below
+        }
+    }
+    if (known && memo->mode == MemoMode::Use)
+        return *known;
+
+    const auto answer = solve();
+    if (known && *known != answer) {
+        std::ostringstream msg;
+        msg << "part " << N << " answer " << answer << " doesn't match the remembered answer " << *known;
+        throw std::runtime_error{msg.str()};
+    }
+    if (!known) {
+        byte_writer w;
+        serialize(w, answer);
+        store.store(key, w.view());
+    }
+    return answer;
+}
+
+template <class Day>
+static void run_day(const Part part, std::string_view input, std::ostream &out, phase_probe *probe = nullptr,
+                    const parse_cache *cache = nullptr, const answer_memo *memo = nullptr) {
+    AOC_TRACE_SCOPE_ARG("day", "day", Day::number);
+    // Everything the run allocates, from the parsed input on, goes in one arena that is released when it returns. It
+    // must outlive input_parsed.
+    const arena_scope arena;
+
+    // Only parsed once a part actually needs working out, so that remembered answers don't need parsing at all
+    std::optional<typename Day::input_type> input_parsed;
+    const auto parsed = [&input_parsed, input, probe, cache]() -> typename Day::input_type & {
+        if (!input_parsed)
+            input_parsed.emplace(measure(probe, "parse", [input, cache] {
+                return parse<Day>(input, cache);
+            }));
+        return *input_parsed;
+    };
+
+    if (part == Part::BothParts || part == Part::Part1)
+        out << memoized<Day, 1>(memo, input, [&parsed, probe] {
+            auto &in = parsed();
+            return measure(probe, "part1", [&in] {
+                return Day::part1(in);
+            });
+        }) << std::endl;
+    if (part == Part::BothParts || part == Part::Part2) {
+        if constexpr (Day::has_part2)
+            out << memoized<Day, 2>(memo, input, [&parsed, probe] {
+                auto &in = parsed();
+                return measure(probe, "part2", [&in] {
+                    return Day::part2(in);
+                });
+            }) << std::endl;
+        else
+            out << "error: part not yet implemented" << std::endl;
+    }
+    if (probe)
+        probe->report(out);
+}
+
+static int run_aoc(const long day, const Part part, std::string_view input, const bool counters,
+                   const parse_cache *cache, const answer_memo *memo) {
+    bool found;
+    try {
+        found = with_day(day, [part, input, counters, cache, memo](auto d) {
+            std::optional<phase_probe> probe;
+            if (counters || alloc_counter::enabled)
+                probe.emplace(counters);
+            run_day<decltype(d)>(part, input, std::cout, probe ? &*probe : nullptr, cache, memo);
+        });
+    } catch (const std::runtime_error &e) {
+        std::cout << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!found) {
+        std::cout << "error: day not yet implemented" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Runs every day in the registry concurrently, reading day N's input from input_dir/dayN-input.txt. Each day's
+// answers are buffered and printed in day order once everything is done so that the output is deterministic.
+static int run_all(const Part part, const std::string &input_dir, const bool counters, const parse_cache *cache,
+                   const answer_memo *memo) {
+    struct job {
+        long number;
+        unsigned weight;
+        std::string output;
+        bool ok;
+        std::future<void> done;
+    };
+    std::vector<job> jobs;
+
+    for_each_day([&jobs](auto d) {
+        using Day = decltype(d);
+        jobs.push_back(job{Day::number, Day::weight, {}, false, {}});
+    });
+
+    // Longest-running days go first so that they aren't left running on their own at the end
+    std::vector<job *> schedule;
+    for (auto &j : jobs)
+        schedule.push_back(&j);
+    std::stable_sort(std::begin(schedule), std::end(schedule), [](const job *a, const job *b) {
+        return a->weight > b->weight;
+    });
+
+    {
+        thread_pool pool;
+        for (auto *j : schedule) {
+            j->done = pool.submit([j, part, &input_dir, counters, cache, memo] {
+                std::ostringstream out;
+                const auto input_path = input_dir + "/day" + std::to_string(j->number) + "-input.txt";
+                const mapped_file input{input_path.c_str()};
+                if (!input) {
+                    out << "error: opening " << input_path << " failed." << std::endl;
+                } else {
+                    try {
+                        with_day(j->number, [part, &input, &out, counters, cache, memo](auto d) {
+                            // Counters follow the thread that opened them, so each job needs its own
+                            std::optional<phase_probe> probe;
+                            if (counters || alloc_counter::enabled)
+                                probe.emplace(counters);
+                            run_day<decltype(d)>(part, input, out, probe ? &*probe : nullptr, cache, memo);
+                        });
+                        j->ok = true;
+                    } catch (const std::exception &e) {
+                        out << "error: " << e.what() << std::endl;
+                    }
+                }
+                j->output = out.str();
+            });
+        }
+    }
+
+    auto ret = EXIT_SUCCESS;
+    for (const auto &j : jobs) {
+        std::cout << "Day " << j.number << ":\n" << j.output;
+        if (!j.ok)
+            ret = EXIT_FAILURE;
+    }
+    std::cout.flush();
+
+    return ret;
+}
+
+// Runs one day on many inputs, printing a line of answers for each input in the order they were given as soon as it and
+// every input before it are done. The calling thread maps each file in turn, which reads it in, while the pool works
+// on earlier ones, staying at most a couple of files per worker ahead so that a long list of inputs isn't all held in
+// memory at once.
+static int run_batch(const long day, const Part part, const std::vector<std::string> &paths, const parse_cache *cache,
+                     const answer_memo *memo) {
+    if (!with_day(day, [](auto) {})) {
+        std::cout << "error: day not yet implemented" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    struct result {
+        std::string answers;
+        bool ok = false, done = false;
+    };
+    std::vector<result> results(paths.size());
+    std::size_t in_flight = 0, printed = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
     auto ret = EXIT_SUCCESS;
 
-    switch (day) {
-    case 0: {
-        auto input_parsed = day0::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day0::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day0::part2(input_parsed) << std::endl;
-    } break;
-    case 1: {
-        auto input_parsed = day1::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day1::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day1::part2(input_parsed) << std::endl;
-    } break;
-    case 2: {
-        auto input_parsed = day2::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day2::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day2::part2(input_parsed) << std::endl;
-    } break;
-    case 3:
-        switch (part) {
-        case Part::BothParts:
-            std::cout << day3::part1(input) << std::endl;
-            // Rewind before doing part 2
-            input.clear(); // https://stackoverflow.com/a/28331018
-            input.seekg(0);
-            std::cout << day3::part2(input) << std::endl;
+    // Must be called with mutex held
+    const auto print_finished = [&results, &printed, &paths, &ret] {
+        for (; printed < results.size() && results[printed].done; printed++) {
+            std::cout << paths[printed] << ": " << results[printed].answers << '\n';
+            if (!results[printed].ok)
+                ret = EXIT_FAILURE;
+        }
+        std::cout.flush();
+    };
+
+    {
+        thread_pool pool;
+        const auto window = 2 * pool.size();
+        for (std::size_t i = 0; i < paths.size(); i++) {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                cv.wait(lock, [&in_flight, window] {
+                    return in_flight < window;
+                });
+                in_flight++;
+            }
+
+            auto input = std::make_shared<const mapped_file>(paths[i].c_str());
+            pool.submit([&, i, input] {
+                std::ostringstream out;
+                auto ok = false;
+                if (!*input) {
+                    out << "error: opening " << paths[i] << " failed.";
+                } else {
+                    try {
+                        with_day(day, [part, &input, &out, cache, memo](auto d) {
+                            run_day<decltype(d)>(part, *input, out, nullptr, cache, memo);
+                        });
+                        ok = true;
+                    } catch (const std::exception &e) {
+                        out << "error: " << e.what();
+                    }
+                }
+
+                // run_day() puts each answer on a line of its own
+                auto answers = out.str();
+                while (!answers.empty() && answers.back() == '\n')
+                    answers.pop_back();
+                std::replace(std::begin(answers), std::end(answers), '\n', ' ');
+
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    results[i] = result{std::move(answers), ok, true};
+                    in_flight--;
+                    print_finished();
+                }
+                cv.notify_one();
+            });
+        }
+    }
+
+    return ret;
+}
+
+// A buffer of whole lines of input for stream mode
+struct stream_chunk {
+    std::unique_ptr<char[]> data;
+    std::size_t size = 0;
+};
+
+// Runs a day on input read from fd as a pipeline, for days whose answers can be worked out a run of whole lines at a
+// time (see line_streaming). This thread reads the input into a fixed set of chunks, each cut where the day allows, and
+// hands them to the pool's workers through one ring; each worker parses and solves the chunks it takes and hands them
+// back through another ring to be refilled. Memory use is the same however long the input is, and reading overlaps
+// with parsing and solving. Throws std::runtime_error if the input can't be read or has more than a chunk's worth that
+// can't be cut (a line, or for day 0 a number).
+template <class Day>
+static void stream_day(const Part part, const int fd, std::ostream &out) {
+    using streaming = line_streaming<Day::number>;
+    using part1_output = typename Day::part1_output;
+    using part2_output = typename Day::part2_output;
+    constexpr std::size_t chunk_size = 1 << 20;
+    const auto run_part1 = part == Part::BothParts || part == Part::Part1,
+               run_part2 = Day::has_part2 && (part == Part::BothParts || part == Part::Part2);
+
+    thread_pool pool;
+    // Enough for every worker to have one chunk on the go and another waiting, while this thread fills a third
+    const auto n_chunks = 2 * pool.size() + 1;
+    std::vector<stream_chunk> chunks(n_chunks);
+    // Full chunks, then a null pointer per worker to say there are no more
+    ring_buffer<stream_chunk *> full{n_chunks + pool.size()}, empty{n_chunks};
+    for (auto &c : chunks) {
+        c.data.reset(new char[chunk_size]);
+        empty.push(&c);
+    }
+
+    std::mutex mutex;
+    std::optional<part1_output> answer1;
+    std::optional<part2_output> answer2;
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+    const auto fail = [&mutex, &error, &failed](std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!error)
+            error = e;
+        failed = true;
+    };
+
+    std::vector<std::future<void>> workers;
+    for (std::size_t i = 0; i < pool.size(); i++) {
+        workers.push_back(pool.submit([&, run_part1, run_part2] {
+            std::optional<part1_output> a1;
+            std::optional<part2_output> a2;
+            for (stream_chunk *c; (c = full.pop());) {
+                // After a failure chunks are just handed back, so that the reader never waits for one forever
+                if (!failed) {
+                    try {
+                        const arena_scope arena;
+                        auto input = Day::parse(std::string_view{c->data.get(), c->size});
+                        if (run_part1) {
+                            const auto a = Day::part1(input);
+                            a1 = a1 ? static_cast<part1_output>(typename streaming::merge1{}(*a1, a)) : a;
+                        }
+                        if constexpr (Day::has_part2) {
+                            if (run_part2) {
+                                const auto a = Day::part2(input);
+                                a2 = a2 ? static_cast<part2_output>(typename streaming::merge2{}(*a2, a)) : a;
+                            }
+                        }
+                    } catch (...) {
+                        fail(std::current_exception());
+                    }
+                }
+                empty.push(c);
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+            if (a1)
+                answer1 = answer1 ? static_cast<part1_output>(typename streaming::merge1{}(*answer1, *a1)) : *a1;
+            if constexpr (Day::has_part2)
+                if (a2)
+                    answer2 = answer2 ? static_cast<part2_output>(typename streaming::merge2{}(*answer2, *a2)) : *a2;
+        }));
+    }
+
+    // Fill each chunk right up, then send as much of it as can be cut off and carry the rest over to the next.
+    // The last chunk goes however full it is, even empty, so that there is always at least one.
+    auto *c = empty.pop();
+    std::size_t filled = 0;
+    for (auto eof = false; !eof && !failed;) {
+        const auto n = read(fd, c->data.get() + filled, chunk_size - filled);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            fail(std::make_exception_ptr(
+                std::runtime_error{std::string{"reading input failed: "} + std::strerror(errno)}));
             break;
-        case Part::Part1: std::cout << day3::part1(input) << std::endl; break;
-        case Part::Part2: std::cout << day3::part2(input) << std::endl;
         }
+        filled += n;
+        eof = n == 0;
+        if (eof) {
+            c->size = filled;
+            full.push(c);
+        } else if (filled == chunk_size) {
+            c->size = streaming::cut(std::string_view{c->data.get(), filled});
+            if (c->size == 0) {
+                fail(std::make_exception_ptr(std::runtime_error{"input has more than " + std::to_string(chunk_size) +
+                                                                " bytes in a row with nowhere to cut it"}));
+                break;
+            }
+            auto *next = empty.pop();
+            filled -= c->size;
+            std::memcpy(next->data.get(), c->data.get() + c->size, filled);
+            full.push(c);
+            c = next;
+        }
+    }
+
+    for (std::size_t i = 0; i < pool.size(); i++)
+        full.push(nullptr);
+    for (auto &w : workers)
+        w.get();
+    if (error)
+        std::rethrow_exception(error);
+
+    if (run_part1)
+        out << *answer1 << std::endl;
+    if (part == Part::BothParts || part == Part::Part2) {
+        if constexpr (Day::has_part2)
+            out << *answer2 << std::endl;
+        else
+            out << "error: part not yet implemented" << std::endl;
+    }
+}
+
+static int stream_aoc(const long day, const Part part) {
+    bool streamable = true;
+    try {
+        const auto found = with_day(day, [part, &streamable](auto d) {
+            using Day = decltype(d);
+            if constexpr (line_streaming<Day::number>::supported)
+                stream_day<Day>(part, STDIN_FILENO, std::cout);
+            else
+                streamable = false;
+        });
+        if (!found) {
+            std::cout << "error: day not yet implemented" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::cout << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!streamable) {
+        std::cout << "error: day " << day << " needs all of its input at once, so can't stream it from stdin"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// The answers to each distinct line of an input being watched, for the days whose answers can be worked out a line at
+// a time (see line_streaming), so that when the file changes only the lines that are new or different are parsed and
+// solved again and the rest are merged from here. Lines are known by a hash of their text rather than their position,
+// so lines that have merely moved (say because another was inserted above them) aren't solved again either.
+template <class Day>
+class line_answers {
+    using streaming = line_streaming<Day::number>;
+    using part1_output = typename Day::part1_output;
+    using part2_output = typename Day::part2_output;
+
+    struct answers {
+        std::optional<part1_output> part1;
+        std::optional<part2_output> part2;
+    };
+
+    const Part part;
+    const bool run_part1, run_part2;
+    // 64 bits of hash is as good as the text itself for any input that fits in memory
+    std::unordered_map<std::uint64_t, answers> lines;
+
+    answers solve(std::string_view line) const {
+        // Most lines need very little scratch memory, so start with some that doesn't need allocating
+        std::byte buffer[4096];
+        std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer)};
+        const arena_scope scope{&arena};
+
+        answers a;
+        auto input = Day::parse(line);
+        if (run_part1)
+            a.part1 = Day::part1(input);
+        if constexpr (Day::has_part2)
+            if (run_part2)
+                a.part2 = Day::part2(input);
+        return a;
+    }
+
+public:
+    explicit line_answers(const Part part)
+        : part{part}, run_part1{part == Part::BothParts || part == Part::Part1},
+          run_part2{Day::has_part2 && (part == Part::BothParts || part == Part::Part2)} {}
+
+    // Brings the answers up to date with input and prints them
+    void update(std::string_view input, std::ostream &out) {
+        const line_index index{input};
+        std::unordered_map<std::uint64_t, answers> next;
+        std::optional<part1_output> answer1;
+        std::optional<part2_output> answer2;
+        try {
+            // Like a stream, an empty input is solved as one empty run of lines
+            for (line_index::size_type i = 0; i < std::max<line_index::size_type>(index.size(), 1); i++) {
+                const auto line = index.size() ? index.line(i) : input;
+                const auto key = hash_bytes(line);
+                auto it = next.find(key);
+                if (it == std::end(next)) {
+                    if (auto node = lines.extract(key)) {
+                        it = next.insert(std::move(node)).position;
+                    } else {
+                        it = next.emplace(key, solve(line)).first;
+                    }
+                }
+
+                const auto &a = it->second;
+                if (a.part1)
+                    answer1 = answer1 ? static_cast<part1_output>(typename streaming::merge1{}(*answer1, *a.part1))
+                                      : *a.part1;
+                if constexpr (Day::has_part2)
+                    if (a.part2)
+                        answer2 = answer2 ? static_cast<part2_output>(typename streaming::merge2{}(*answer2, *a.part2))
+                                          : *a.part2;
+            }
+        } catch (...) {
+            // Keep what was solved, both before and this time, for when the bad line is fixed
+            lines.merge(next);
+            throw;
+        }
+        lines = std::move(next);
+
+        if (run_part1)
+            out << *answer1 << std::endl;
+        if (part == Part::BothParts || part == Part::Part2) {
+            if constexpr (Day::has_part2)
+                out << *answer2 << std::endl;
+            else
+                out << "error: part not yet implemented" << std::endl;
+        }
+    }
+};
+
+// Waits on fd, an inotify instance watching a directory, for something to change the file called name in it. Bursts of
+// changes (e.g. a long write, which arrives as many modifications) are waited out and count as one. Returns false if
+// the instance can't be read.
+static bool wait_for_change(const int fd, const std::string &name) {
+    alignas(inotify_event) char buffer[4096];
+    for (auto changed = false;;) {
+        // Block until the first change, then only give the rest of the burst a moment to arrive
+        pollfd p{fd, POLLIN, 0};
+        const auto ready = poll(&p, 1, changed ? 50 : -1);
+        if (ready == -1 && errno == EINTR)
+            continue;
+        if (ready == -1)
+            return false;
+        if (ready == 0)
+            return true;
+
+        const auto n = read(fd, buffer, sizeof(buffer));
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        for (const char *p = buffer; p < buffer + n;) {
+            const auto *const event = reinterpret_cast<const inotify_event *>(p);
+            if (event->len && name == event->name)
+                changed = true;
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+// Calls run() with the contents of the file at path, then again every time wait_for_change() says it has changed,
+// until that fails. Errors in any one run are reported and the watching carries on.
+template <class F>
+static void each_version(const std::string &path, const int fd, const std::string &name, F &&run) {
+    do {
+        const mapped_file input{path.c_str()};
+        if (!input) {
+            // Perhaps caught in the middle of being replaced, so wait for the new one
+            std::cout << "error: opening " << path << " failed." << std::endl;
+            continue;
+        }
+        try {
+            run(input.view());
+        } catch (const std::exception &e) {
+            std::cout << "error: " << e.what() << std::endl;
+        }
+    } while (wait_for_change(fd, name));
+}
+
+// Runs a day on the input at path, then again every time the file changes, until interrupted. Days whose answers can
+// be worked out a line at a time only solve the lines that changed; the rest are run afresh. The directory the file
+// is in is watched rather than the file itself, so that editors that save by writing a new file and renaming it over
+// the old one are followed too.
+static int watch_aoc(const long day, const Part part, const std::string &path, const parse_cache *cache,
+                     const answer_memo *memo) {
+    const auto slash = path.rfind('/');
+    const auto dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const auto name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+
+    const auto fd = inotify_init1(IN_CLOEXEC);
+    if (fd == -1 || inotify_add_watch(fd, dir.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO) == -1) {
+        std::cout << "error: watching " << path << " failed: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto found = with_day(day, [part, &path, &name, fd, cache, memo](auto d) {
+        using Day = decltype(d);
+        if constexpr (line_streaming<Day::number>::supported) {
+            line_answers<Day> answers{part};
+            each_version(path, fd, name, [&answers](std::string_view input) {
+                answers.update(input, std::cout);
+            });
+        } else {
+            each_version(path, fd, name, [part, cache, memo](std::string_view input) {
+                run_day<Day>(part, input, std::cout, nullptr, cache, memo);
+            });
+        }
+    });
+    if (!found) {
+        std::cout << "error: day not yet implemented" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "error: watching " << path << " failed: " << std::strerror(errno) << std::endl;
+    return EXIT_FAILURE;
+}
+
+// Reads a list of input paths, one per line. Blank lines are skipped.
+static bool read_manifest(const char *path, std::vector<std::string> &paths) {
+    const mapped_file manifest{path};
+    if (!manifest)
+        return false;
+
+    auto rest = manifest.view();
+    while (!rest.empty()) {
+        const auto eol = rest.find('\n');
+        const auto line = rest.substr(0, eol);
+        rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
+        if (!line.empty())
+            paths.emplace_back(line);
+    }
+
+    return true;
+}
+
+struct phase_samples {
+    const char *phase;
+    std::vector<double> ns;
+    // How long of each sample was spent waiting in parallel loops (see parallel_wait_ns())
+    std::vector<double> wait_ns;
+};
+
+// Times the parse, part 1 and part 2 phases of a day separately. Every iteration re-parses the input (or reloads it
+// from cache) before running the parts on it, exactly like a normal run does, since some parts (e.g. day 1's) modify
+// their input.
+template <class Day>
+static std::vector<phase_samples> bench_day(const Part part, std::string_view input, long iterations, long warmup,
+                                            const parse_cache *cache) {
+    const auto run_part1 = part == Part::BothParts || part == Part::Part1,
+               run_part2 = Day::has_part2 && (part == Part::BothParts || part == Part::Part2);
+    std::vector<phase_samples> phases{{"parse", {}, {}}, {"part1", {}, {}}, {"part2", {}, {}}};
+    for (auto &p : phases) {
+        p.ns.reserve(iterations);
+        p.wait_ns.reserve(iterations);
+    }
+    const auto sample = [&phases](long i, std::size_t phase, const stopwatch &sw, std::uint64_t wait_before) {
+        const auto ns = sw.elapsed_ns();
+        if (i >= 0) {
+            phases[phase].ns.push_back(ns);
+            phases[phase].wait_ns.push_back(static_cast<double>(parallel_wait_ns() - wait_before));
+        }
+    };
+
+    for (auto i = -warmup; i < iterations; i++) {
+        // A fresh arena for each iteration, as for each normal run
+        const arena_scope arena;
+        auto wait_before = parallel_wait_ns();
+        stopwatch sw;
+        auto input_parsed = parse<Day>(input, cache);
+        sample(i, 0, sw, wait_before);
+
+        if (run_part1) {
+            wait_before = parallel_wait_ns();
+            sw.reset();
+            Day::part1(input_parsed);
+            sample(i, 1, sw, wait_before);
+        }
+
+        if (run_part2) {
+            wait_before = parallel_wait_ns();
+            sw.reset();
+            Day::part2(input_parsed);
+            sample(i, 2, sw, wait_before);
+        }
+    }
+
+    phases.erase(std::remove_if(std::begin(phases), std::end(phases),
+                                [](const phase_samples &p) {
+                                    return p.ns.empty();
+                                }),
+                 std::end(phases));
+    return phases;
+}
+
+static void report_bench(const long day, const long iterations, const long warmup,
+                         const std::vector<phase_samples> &phases, const Format format) {
+    switch (format) {
+    case Format::Text:
+        std::cout << "day " << day << ", " << iterations << " iterations after " << warmup << " warmup, "
+                  << simd_level_name(best_simd_level()) << " kernels, " << engine_name(selected_engine())
+                  << " engine\n";
+        std::cout << std::left << std::setw(8) << "phase" << std::right << std::setw(14) << "min (us)"
+                  << std::setw(14) << "median (us)" << std::setw(14) << "p99 (us)" << '\n';
+        std::cout << std::fixed << std::setprecision(3);
+        for (const auto &p : phases) {
+            const auto s = summarize(p.ns);
+            std::cout << std::left << std::setw(8) << p.phase << std::right << std::setw(14) << s.min / 1000
+                      << std::setw(14) << s.median / 1000 << std::setw(14) << s.p99 / 1000 << '\n';
+        }
+        break;
+    case Format::Json:
+        std::cout << "{\"day\":" << day << ",\"iterations\":" << iterations << ",\"warmup\":" << warmup
+                  << ",\"simd\":\"" << simd_level_name(best_simd_level()) << "\",\"engine\":\""
+                  << engine_name(selected_engine()) << "\",\"unit\":\"ns\",\"phases\":[";
+        std::cout << std::fixed << std::setprecision(0);
+        for (auto it = std::cbegin(phases); it != std::cend(phases); it++) {
+            const auto s = summarize(it->ns);
+            if (it != std::cbegin(phases))
+                std::cout << ',';
+            std::cout << "{\"phase\":\"" << it->phase << "\",\"min\":" << s.min << ",\"median\":" << s.median
+                      << ",\"p99\":" << s.p99 << '}';
+        }
+        std::cout << "]}\n";
         break;
-    case 4: {
-        auto input_parsed = day4::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day4::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day4::part2(input_parsed) << std::endl;
-    } break;
-    case 5: {
-        auto input_parsed = day5::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day5::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day5::part2(input_parsed) << std::endl;
-    } break;
-    case 6: {
-        auto input_parsed = day6::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day6::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day6::part2(input_parsed) << std::endl;
-    } break;
-    case 7: {
-        auto input_parsed = day7::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day7::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << day7::part2(input_parsed) << std::endl;
-    } break;
-    case 8: {
-        auto input_parsed = day8::parse_input(input);
-        if (part == Part::BothParts || part == Part::Part1)
-            std::cout << day8::part1(input_parsed) << std::endl;
-        if (part == Part::BothParts || part == Part::Part2)
-            std::cout << "error: part not yet implemented" << std::endl;
-    } break;
-    default: std::cout << "error: day not yet implemented" << std::endl; ret = EXIT_FAILURE;
+    case Format::Csv:
+        std::cout << "day,phase,iterations,min_ns,median_ns,p99_ns\n";
+        std::cout << std::fixed << std::setprecision(0);
+        for (const auto &p : phases) {
+            const auto s = summarize(p.ns);
+            std::cout << day << ',' << p.phase << ',' << iterations << ',' << s.min << ',' << s.median << ','
+                      << s.p99 << '\n';
+        }
+    }
+    std::cout.flush();
+}
+
+static int bench_aoc(const long day, const Part part, std::string_view input, const long iterations,
+                     const Format format, const parse_cache *cache) {
+    // Enough warmup to fault in the input and get the allocator and caches into a steady state
+    const auto warmup = std::max(1L, iterations / 10);
+    const auto found = with_day(day, [&](auto d) {
+        report_bench(day, iterations, warmup, bench_day<decltype(d)>(part, input, iterations, warmup, cache), format);
+    });
+
+    if (!found) {
+        std::cout << "error: day not yet implemented" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// How long each of a part's engines took on one input, or a negative time for the engines the part doesn't have
+struct engine_timing {
+    std::size_t size;
+    double ns[engine_count];
+};
+
+// Times each of engines' engines on input by the median of a few runs, after one to warm up
+template <class Set, class Input>
+static engine_timing time_engines(const Set &engines, const Input &input) {
+    constexpr int runs = 5;
+    engine_timing timing{engines.size(input), {}};
+    for (std::size_t i = 0; i < engine_count; i++) {
+        const auto e = static_cast<engine>(i);
+        timing.ns[i] = -1;
+        if (!engines.has(e))
+            continue;
+
+        std::vector<double> samples;
+        for (auto run = -1; run < runs; run++) {
+            const arena_scope arena;
+            stopwatch sw;
+            engines.variant(e)(input);
+            if (run >= 0)
+                samples.push_back(sw.elapsed_ns());
+        }
+        timing.ns[i] = summarize(std::move(samples)).median;
+    }
+    return timing;
+}
+
+// The least-squares fit of engine e's times to a + b * size, as {a, b}
+static std::pair<double, double> fit_times(const std::vector<engine_timing> &timings, std::size_t e) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const auto &t : timings) {
+        const auto x = static_cast<double>(t.size);
+        sx += x;
+        sy += t.ns[e];
+        sxx += x * x;
+        sxy += x * t.ns[e];
+    }
+    const auto n = static_cast<double>(timings.size());
+    const auto b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    return {(sy - b * sx) / n, b};
+}
+
+// Prints each input's timings for a part, then for each engine above the reference the size from which it beats the
+// engine below it, which is what that engine's threshold should be, next to the threshold it has now
+template <class Set>
+static void report_tuning(const Set &engines, const std::vector<engine_timing> &timings) {
+    std::cout << engines.name() << ":\n" << std::fixed << std::setprecision(3);
+    for (const auto &t : timings) {
+        std::cout << "  " << t.size << ' ' << engines.unit();
+        auto separator = ": ";
+        for (std::size_t i = 0; i < engine_count; i++) {
+            if (t.ns[i] >= 0) {
+                std::cout << separator << engine_name(static_cast<engine>(i)) << ' ' << t.ns[i] / 1000 << " us";
+                separator = ", ";
+            }
+        }
+        std::cout << '\n';
+    }
+
+    auto distinct_sizes = false;
+    for (const auto &t : timings)
+        distinct_sizes = distinct_sizes || t.size != timings.front().size;
+    if (!distinct_sizes) {
+        std::cout << "  (give inputs of at least two sizes for suggested thresholds)\n";
+        return;
+    }
+
+    for (std::size_t i = 1; i < engine_count; i++) {
+        const auto e = static_cast<engine>(i);
+        if (!engines.has(e))
+            continue;
+        const auto below = engines.resolve(static_cast<engine>(i - 1));
+        const auto [a, b] = fit_times(timings, i);
+        const auto [a_below, b_below] = fit_times(timings, static_cast<std::size_t>(below));
+
+        std::cout << "  " << engine_name(e) << " over " << engine_name(below) << ": ";
+        if (b < b_below) {
+            // Where the two lines cross, beyond which e is the faster one
+            const auto crossover = std::max(0.0, std::ceil((a - a_below) / (b_below - b)));
+            std::cout << "from " << std::setprecision(0) << crossover << std::setprecision(3) << ' ' << engines.unit();
+        } else if (a < a_below) {
+            std::cout << "from 0 " << engines.unit();
+        } else {
+            std::cout << "never";
+        }
+        std::cout << " (threshold now " << engines.threshold(e) << ")\n";
+    }
+}
+
+// Times every engine of each of the day's parts that has more than one against each other on every input in turn, for
+// working out the thresholds that auto picks engines by
+template <class Day>
+static int tune_day(const Part part, const std::vector<std::string> &input_paths, const parse_cache *cache) {
+    using engines = day_engines<Day::number>;
+    constexpr auto tune_part1 = !std::is_null_pointer_v<decltype(engines::part1)>,
+                   tune_part2 = !std::is_null_pointer_v<decltype(engines::part2)>;
+    const auto run_part1 = tune_part1 && (part == Part::BothParts || part == Part::Part1),
+               run_part2 = tune_part2 && (part == Part::BothParts || part == Part::Part2);
+    if (!run_part1 && !run_part2) {
+        std::cout << "error: day " << Day::number << " has nothing to tune, with only one engine for each part"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (thread_pool::default_size() == 1)
+        std::cout << "note: parallel engines only get one thread, so their timings don't say much\n";
+
+    std::vector<engine_timing> part1_timings, part2_timings;
+    for (const auto &path : input_paths) {
+        const mapped_file input{path.c_str()};
+        if (!input) {
+            std::cout << "error: opening " << path << " failed." << std::endl;
+            return EXIT_FAILURE;
+        }
+        const arena_scope arena;
+        const auto parsed = parse<Day>(input, cache);
+        if constexpr (tune_part1)
+            if (run_part1)
+                part1_timings.push_back(time_engines(*engines::part1, parsed));
+        if constexpr (tune_part2)
+            if (run_part2)
+                part2_timings.push_back(time_engines(*engines::part2, parsed));
+    }
+
+    if constexpr (tune_part1)
+        if (run_part1)
+            report_tuning(*engines::part1, part1_timings);
+    if constexpr (tune_part2)
+        if (run_part2)
+            report_tuning(*engines::part2, part2_timings);
+    return EXIT_SUCCESS;
+}
+
+static int tune_aoc(const long day, const Part part, const std::vector<std::string> &input_paths,
+                    const parse_cache *cache) {
+    auto ret = EXIT_SUCCESS;
+    bool found;
+    try {
+        found = with_day(day, [part, &input_paths, cache, &ret](auto d) {
+            ret = tune_day<decltype(d)>(part, input_paths, cache);
+        });
+    } catch (const std::runtime_error &e) {
+        std::cout << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!found) {
+        std::cout << "error: day not yet implemented" << std::endl;
+        return EXIT_FAILURE;
     }
 
     return ret;
 }
 
-int main(int argc, char *argv[]) {
-    std::cout << "This is the Advent of Code 2024\n";
+// How many sizes of input --scaling times each day on, each twice the scale of the last. It stops early, once it has
+// enough to fit to, if a size takes longer than scaling_budget_ns, as the next is likely to take many times as long.
+constexpr std::size_t scaling_sizes = 5, scaling_min_sizes = 3;
+constexpr double scaling_budget_ns = 1e9;
+
+// A day's timings on one size of generated input, with the median of each phase in the same order as bench_day()
+// returns them
+struct scaling_point {
+    std::size_t scale, bytes;
+    std::vector<double> ns;
+};
+
+// The least-squares fit of log(time) to log(bytes) for one phase: the exponent k of time = c * bytes^k that the times
+// grow by, and r2, the share of the spread in the times that the fit accounts for (1 when it goes through every one)
+struct growth_fit {
+    double exponent, r2;
+};
+
+static growth_fit fit_exponent(const std::vector<scaling_point> &points, std::size_t phase) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    for (const auto &p : points) {
+        const auto x = std::log(static_cast<double>(p.bytes)), y = std::log(std::max(p.ns[phase], 1.0));
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        syy += y * y;
+    }
+    const auto n = static_cast<double>(points.size());
+    const auto var_x = n * sxx - sx * sx, var_y = n * syy - sy * sy, cov = n * sxy - sx * sy;
+    return {cov / var_x, var_y > 0 ? cov * cov / (var_x * var_y) : 1};
+}
+
+// Whether the phase took at least as long on each size as on the one before, without which an exponent fitted to its
+// times would only be describing noise
+static bool grows_steadily(const std::vector<scaling_point> &points, std::size_t phase) {
+    return std::is_sorted(std::begin(points), std::end(points), [phase](const auto &a, const auto &b) {
+        return a.ns[phase] < b.ns[phase];
+    });
+}
+
+// The input that --scaling and --thread-scaling time the generator's day on at scale (see scale_worst_case), with its
+// default width and a fixed seed
+static std::string generate_input(const gen::generator &gen, std::size_t scale) {
+    std::ostringstream out;
+    (gen.scale_worst_case ? gen.write_worst_case : gen.write)(out, gen::options{scale, gen.default_width, 1});
+    return std::move(out).str();
+}
+
+// The generator's scaling_start if it has one, or else its default scale, doubled until its input is big enough to
+// time reliably or until doubling it doublings more times would take it past max_scale
+static std::size_t first_timed_scale(const gen::generator &gen, std::size_t doublings) {
+    constexpr std::size_t min_bytes = 1 << 16;
+    if (gen.scaling_start)
+        return gen.scaling_start;
+    auto scale = gen.default_scale;
+    while (generate_input(gen, scale).size() < min_bytes &&
+           (!gen.max_scale || scale << (doublings + 1) <= gen.max_scale))
+        scale *= 2;
+    return scale;
+}
+
+// Times each phase of the day on input over 5 runs, or just the one if that is long enough to be a measurement on its
+// own
+template <class Day>
+static std::vector<phase_samples> time_phases(const Part part, std::string_view input) {
+    constexpr double long_run_ns = 5e8;
+    auto phases = bench_day<Day>(part, input, 1, 0, nullptr);
+    auto total = 0.0;
+    for (const auto &p : phases)
+        total += p.ns.front();
+    return total < long_run_ns ? bench_day<Day>(part, input, 5, 1, nullptr) : phases;
+}
+
+// Runs the day on generated inputs of a geometric series of scales, from one big enough to time reliably upwards, and
+// prints how long each phase took at each one, the exponent its time grows by, how well that fits and whether it is
+// worse than the generator expects of a good solution
+template <class Day>
+static void scale_day(const Part part) {
+    // How far above the expected exponent a measured one has to be to be flagged, which allows for noise
+    constexpr double tolerance = 0.25;
+    const auto *const gen = gen::find_generator(Day::number);
+    if (!gen) {
+        std::cout << "day " << Day::number << ": no input generator\n";
+        return;
+    }
+
+    std::vector<scaling_point> points;
+    std::vector<const char *> phase_names;
+    auto scale = first_timed_scale(*gen, scaling_sizes - 1);
+    for (std::size_t i = 0; i < scaling_sizes; i++, scale *= 2) {
+        if (gen->max_scale)
+            scale = std::min(scale, gen->max_scale);
+        if (!points.empty() && scale == points.back().scale)
+            break;
+        const auto input = generate_input(*gen, scale);
+        const auto phases = time_phases<Day>(part, input);
+
+        scaling_point point{scale, input.size(), {}};
+        phase_names.clear();
+        auto total_ns = 0.0;
+        for (const auto &p : phases) {
+            phase_names.push_back(p.phase);
+            point.ns.push_back(summarize(p.ns).median);
+            total_ns += point.ns.back();
+        }
+        points.push_back(std::move(point));
+        if (points.size() >= scaling_min_sizes && total_ns > scaling_budget_ns)
+            break;
+    }
+
+    std::cout << "day " << Day::number << ": " << gen->scale_meaning << " from " << points.front().scale << " to "
+              << points.back().scale << (gen->scale_worst_case ? ", worst-case inputs" : "") << '\n';
+    std::cout << std::left << std::setw(14) << "  bytes" << std::right;
+    for (const auto &p : points)
+        std::cout << std::setw(14) << p.bytes;
+    std::cout << '\n' << std::fixed << std::setprecision(3);
+    for (std::size_t i = 0; i < phase_names.size(); i++) {
+        std::cout << "  " << std::left << std::setw(12) << (std::string{phase_names[i]} + " (us)") << std::right;
+        for (const auto &p : points)
+            std::cout << std::setw(14) << p.ns[i] / 1000;
+        const auto phase = std::string_view{phase_names[i]} == "parse" ? 0 : phase_names[i][4] - '0';
+        const auto expected = gen->expected_growth[phase];
+        if (!grows_steadily(points, i)) {
+            std::cout << "    no fit, as the times don't grow with the size";
+        } else {
+            const auto fit = fit_exponent(points, i);
+            std::cout << std::setprecision(2) << "    n^" << fit.exponent << " (r^2 " << fit.r2 << ')';
+            if (fit.exponent > expected + tolerance)
+                std::cout << "  worse than n^" << std::defaultfloat << expected << std::fixed << " expected";
+        }
+        std::cout << std::setprecision(3) << '\n';
+    }
+    std::cout.flush();
+}
+
+static int scaling_aoc(const long day, const Part part) {
+    std::cout << "scaling generated inputs by 2 up to " << scaling_sizes - 1 << " times, or until a size takes over "
+              << scaling_budget_ns / 1e9 << " s, median of up to 5 runs each, "
+              << simd_level_name(best_simd_level()) << " kernels, " << engine_name(selected_engine())
+              << " engine; n is the size in bytes\n";
+    try {
+        if (day == ALL_DAYS) {
+            for_each_day([part](auto d) {
+                scale_day<decltype(d)>(part);
+            });
+        } else if (!with_day(day, [part](auto d) {
+                       scale_day<decltype(d)>(part);
+                   })) {
+            std::cout << "error: day not yet implemented" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::runtime_error &e) {
+        std::cout << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// 1, 2, 4 and so on up to max threads, and max itself
+static std::vector<unsigned> thread_counts(const unsigned max) {
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < max; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max);
+    return counts;
+}
+
+// Prints a row of a thread-scaling table for each phase, timed with the given number of threads, against the phases
+// timed with one; strong scaling compares times as they are, weak scaling as times per thread's worth of input
+static void report_thread_scaling(const unsigned threads, const std::vector<phase_samples> &phases,
+                                  const std::vector<phase_samples> &one_thread, const bool weak) {
+    for (std::size_t i = 0; i < phases.size(); i++) {
+        const auto ns = summarize(phases[i].ns).median, wait_ns = summarize(phases[i].wait_ns).median,
+                   one_ns = summarize(one_thread[i].ns).median;
+        const auto speedup = weak ? threads * one_ns / ns : one_ns / ns;
+        std::cout << std::setw(9) << threads << "  " << std::left << std::setw(7) << phases[i].phase << std::right
+                  << std::setprecision(3) << std::setw(14) << ns / 1000 << std::setprecision(2) << std::setw(10)
+                  << speedup << std::setprecision(0) << std::setw(11) << 100 * speedup / threads << '%'
+                  << std::setprecision(3) << std::setw(16) << wait_ns / 1000 << '\n';
+    }
+}
+
+// Times the day on pools of 1, 2, 4 and so on up to -j threads: with the same input every time (strong scaling), and
+// with inputs that grow in bytes with the number of threads (weak scaling). For each phase it prints the time, the
+// speedup and efficiency over one thread, and how long loops waited for their slowest thread.
+template <class Day>
+static int thread_scale_day(const Part part) {
+    const auto *const gen = gen::find_generator(Day::number);
+    if (!gen) {
+        std::cout << "error: day " << Day::number << " has no input generator" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto max_threads = thread_pool::default_size();
+    if (max_threads == 1)
+        std::cout << "note: only one thread, so there is no scaling to measure; raise it with -j\n";
+
+    // Big enough that splitting it over many threads still leaves each a good share
+    const auto scale = first_timed_scale(*gen, 2) << 2;
+    const auto input = generate_input(*gen, scale);
+    // How many times bigger the input gets for a doubling of the scale, so that weak scaling can grow it in step with
+    // the number of threads
+    const auto growth = std::log2(static_cast<double>(generate_input(*gen, scale * 2).size()) / input.size());
+    const auto weak_scale = [gen, scale, growth](unsigned threads) {
+        const auto s = static_cast<std::size_t>(std::llround(scale * std::pow(threads, 1 / growth)));
+        return gen->max_scale ? std::min(s, gen->max_scale) : s;
+    };
+
+    std::vector<std::vector<phase_samples>> strong, weak;
+    const auto counts = thread_counts(max_threads);
+    for (const auto threads : counts) {
+        // Both so that parallel loops run on this many threads, and so that auto picks engines as it would with -j
+        thread_pool pool{threads};
+        const pool_scope scope{pool};
+        thread_pool::set_default_size(threads);
+        strong.push_back(time_phases<Day>(part, input));
+        weak.push_back(time_phases<Day>(part, generate_input(*gen, weak_scale(threads))));
+    }
+    thread_pool::set_default_size(max_threads);
+
+    const auto header = "  threads  phase       time (us)   speedup  efficiency  sync wait (us)\n";
+    std::cout << "strong scaling: " << scale << ' ' << gen->scale_meaning << " (" << input.size()
+              << " bytes) on every number of threads\n"
+              << header << std::fixed;
+    for (std::size_t i = 0; i < counts.size(); i++)
+        report_thread_scaling(counts[i], strong[i], strong.front(), false);
+    std::cout << "weak scaling: " << scale << ' ' << gen->scale_meaning << " (" << input.size()
+              << " bytes) on one thread, growing with the number of threads up to " << weak_scale(max_threads)
+              << '\n'
+              << header;
+    for (std::size_t i = 0; i < counts.size(); i++)
+        report_thread_scaling(counts[i], weak[i], weak.front(), true);
+    std::cout.flush();
+    return EXIT_SUCCESS;
+}
+
+static int thread_scaling_aoc(const long day, const Part part) {
+    std::cout << "day " << day << " on up to " << thread_pool::default_size() << " threads, median of up to 5 runs, "
+              << simd_level_name(best_simd_level()) << " kernels, " << engine_name(selected_engine()) << " engine\n";
+    auto ret = EXIT_SUCCESS;
+    try {
+        if (!with_day(day, [part, &ret](auto d) {
+                ret = thread_scale_day<decltype(d)>(part);
+            })) {
+            std::cout << "error: day not yet implemented" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::runtime_error &e) {
+        std::cout << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return ret;
+}
+
+// A file as it was when we last saw it, so that unchanged files needn't be hashed again
+struct file_identity {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    std::int64_t mtime_ns;
+
+    bool operator==(const file_identity &other) const {
+        return dev == other.dev && ino == other.ino && size == other.size && mtime_ns == other.mtime_ns;
+    }
+};
+
+struct file_identity_hash {
+    std::size_t operator()(const file_identity &id) const {
+        const std::uint64_t fields[] = {static_cast<std::uint64_t>(id.dev), static_cast<std::uint64_t>(id.ino),
+                                        static_cast<std::uint64_t>(id.size), static_cast<std::uint64_t>(id.mtime_ns)};
+        return hash_bytes(fields, sizeof fields);
+    }
+};
+
+struct input_key {
+    long day;
+    std::uint64_t hash;
+    std::size_t size;
+
+    bool operator==(const input_key &other) const {
+        return day == other.day && hash == other.hash && size == other.size;
+    }
+};
+
+struct input_key_hash {
+    std::size_t operator()(const input_key &key) const {
+        return key.hash ^ static_cast<std::size_t>(key.day);
+    }
+};
+
+struct cached_input {
+    // Parts are allowed to modify their input (day 1 sorts it) so only one request may use it at a time
+    std::mutex mutex;
+    // Keeps the puzzle text alive for days whose parsed input is just a view of it
+    std::shared_ptr<const mapped_file> source;
+    // Where the parsed input lives, released in one go when the input is evicted. Declared before parsed, so that it is
+    // destroyed after it.
+    std::pmr::monotonic_buffer_resource arena;
+    std::shared_ptr<void> parsed;
+};
+
+// Parsed inputs for server mode, keyed by day and the content of the input file so that the same puzzle input is only
+// parsed once however many paths it is requested by. Inputs are evicted least recently used first once their estimated
+// total footprint goes over capacity.
+class input_cache {
+    std::mutex mutex;
+    lru_cache<input_key, std::shared_ptr<cached_input>, input_key_hash> inputs;
+    lru_cache<file_identity, std::uint64_t, file_identity_hash> hashes{4096};
+
+public:
+    explicit input_cache(std::size_t capacity) : inputs{capacity} {}
+
+    template <class Day>
+    std::shared_ptr<cached_input> get(const char *path) {
+        struct stat st;
+        if (stat(path, &st) == -1)
+            throw std::runtime_error{std::string{"opening "} + path + " failed."};
+        const file_identity id{st.st_dev, st.st_ino, st.st_size, st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec};
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (const auto *hash = hashes.find(id)) {
+                const input_key key{Day::number, *hash, static_cast<std::size_t>(st.st_size)};
+                if (const auto *entry = inputs.find(key))
+                    return *entry;
+            }
+        }
+
+        auto source = std::make_shared<const mapped_file>(path);
+        if (!*source)
+            throw std::runtime_error{std::string{"opening "} + path + " failed."};
+        const input_key key{Day::number, hash_bytes(source->view()), source->size()};
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            hashes.insert(id, key.hash, 1);
+            if (const auto *entry = inputs.find(key))
+                return *entry;
+        }
+
+        // Parse without holding the lock; if two requests race to parse the same input the second one just wins
+        auto entry = std::make_shared<cached_input>();
+        std::shared_ptr<typename Day::input_type> parsed;
+        {
+            const arena_scope arena{&entry->arena};
+            parsed = std::make_shared<typename Day::input_type>(Day::parse(source->view()));
+        }
+        auto cost = footprint(*parsed);
+        if constexpr (std::is_same_v<typename Day::input_type, std::string_view>) {
+            entry->source = std::move(source);
+            cost += entry->source->size();
+        }
+        entry->parsed = parsed;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        inputs.insert(key, entry, cost);
+        return entry;
+    }
+};
 
+// Answers one "DAY PART PATH" request, where PART is 1, 2 or both
+static std::string serve_request(input_cache &cache, const std::string &request) {
+    std::istringstream iss{request};
+    long day;
+    std::string part_string, path;
+    if (!(iss >> day >> part_string) || !std::getline(iss >> std::ws, path) || path.empty())
+        return "error: expected DAY PART PATH";
+
+    Part part;
+    if (part_string == "1")
+        part = Part::Part1;
+    else if (part_string == "2")
+        part = Part::Part2;
+    else if (part_string == "both")
+        part = Part::BothParts;
+    else
+        return "error: part must be 1, 2 or both";
+
+    std::ostringstream out;
+    out << "ok";
+    try {
+        const auto found = with_day(day, [&cache, &path, part, &out](auto d) {
+            using Day = decltype(d);
+            const auto entry = cache.get<Day>(path.c_str());
+            std::lock_guard<std::mutex> lock{entry->mutex};
+            // Scratch space for the parts, released after the request; the input has an arena of its own
+            const arena_scope arena;
+            auto &input = *static_cast<typename Day::input_type *>(entry->parsed.get());
+            if (part == Part::BothParts || part == Part::Part1)
+                out << ' ' << Day::part1(input);
+            if (part == Part::BothParts || part == Part::Part2) {
+                if constexpr (Day::has_part2)
+                    out << ' ' << Day::part2(input);
+                else
+                    throw std::runtime_error{"part not yet implemented"};
+            }
+        });
+        if (!found)
+            return "error: day not yet implemented";
+    } catch (const std::exception &e) {
+        return std::string{"error: "} + e.what();
+    }
+
+    return out.str();
+}
+
+static void serve(input_cache &cache, std::FILE *in, std::FILE *out) {
+    char *line = nullptr;
+    std::size_t cap = 0;
+    for (ssize_t n; (n = getline(&line, &cap, in)) != -1;) {
+        if (n > 0 && line[n - 1] == '\n')
+            line[--n] = '\0';
+        if (n == 0)
+            continue;
+        const auto response = serve_request(cache, line);
+        std::fputs(response.c_str(), out);
+        std::fputc('\n', out);
+        std::fflush(out);
+    }
+    std::free(line);
+}
+
+// Answers requests one per line, either on stdin if socket_path is "-" or from any number of clients connecting to a
+// Unix domain socket at socket_path. Parsed inputs are cached across requests and clients.
+static int run_server(const char *socket_path, const std::size_t cache_capacity) {
+    input_cache cache{cache_capacity};
+
+    if (std::strcmp(socket_path, "-") == 0) {
+        serve(cache, stdin, stdout);
+        return EXIT_SUCCESS;
+    }
+
+    // A client hanging up early shouldn't take the whole server down
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(socket_path) >= sizeof addr.sun_path) {
+        std::cout << "error: socket path " << socket_path << " is too long." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::strcpy(addr.sun_path, socket_path);
+
+    const auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path);
+    if (listener == -1 || bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof addr) == -1 ||
+        listen(listener, SOMAXCONN) == -1) {
+        std::cout << "error: listening on " << socket_path << " failed: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "listening on " << socket_path << std::endl;
+
+    for (;;) {
+        const auto client = accept(listener, nullptr, nullptr);
+        if (client == -1) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            std::cout << "error: accept failed: " << std::strerror(errno) << std::endl;
+            close(listener);
+            return EXIT_FAILURE;
+        }
+
+        std::thread{[&cache, client] {
+            auto *in = fdopen(client, "r");
+            auto *out = fdopen(dup(client), "w");
+            if (in && out)
+                serve(cache, in, out);
+            if (in)
+                std::fclose(in);
+            if (out)
+                std::fclose(out);
+        }}.detach();
+    }
+}
+
+// Parses a number of bytes with an optional K, M or G suffix. Returns 0 if s isn't one, or is too big for a size_t.
+static std::size_t parse_size(const char *s) {
+    // strtoull would skip leading spaces and quietly negate a leading -
+    if (*s < '0' || *s > '9')
+        return 0;
+    char *end;
+    errno = 0;
+    const auto n = std::strtoull(s, &end, 10);
+    if (errno == ERANGE || n > SIZE_MAX)
+        return 0;
+    unsigned shift;
+    switch (*end) {
+    case '\0': return n;
+    case 'K': shift = 10; break;
+    case 'M': shift = 20; break;
+    case 'G': shift = 30; break;
+    default: return 0;
+    }
+    if (end[1] || n > SIZE_MAX >> shift)
+        return 0;
+    return static_cast<std::size_t>(n) << shift;
+}
+
+int main(int argc, char *argv[]) {
     const char *const progname = argv[0];
     int opt;
     char *str_end;
-    auto day = -1L;
+    auto day = -1L, iterations = 0L;
     auto part = Part::BothParts;
+    auto format = Format::Text;
+    auto counters = false;
+    const char *trace_path = nullptr, *socket_path = nullptr, *cache_dir = nullptr;
+    const char *memo_dir = nullptr, *manifest_path = nullptr;
+    bool rebuild_cache = false, watch = false, tune = false, scaling = false, thread_scaling = false;
+    auto memo_mode = MemoMode::Use;
+    std::size_t cache_capacity = 1UL << 30;
 
-    while ((opt = getopt(argc, argv, OPTSTRING)) != -1) {
+    while ((opt = getopt_long(argc, argv, OPTSTRING, LONG_OPTIONS, nullptr)) != -1) {
         switch (opt) {
         case 'd':
+            if (std::strcmp(optarg, "all") == 0) {
+                day = ALL_DAYS;
+                break;
+            }
             day = std::strtol(optarg, &str_end, 10);
             if (optarg == str_end || day < 0 || day > 25) {
                 std::cout << "error: day must be a number in the range [0-25]\n";
@@ -141,27 +1711,224 @@ int main(int argc, char *argv[]) {
                 usage(progname, EXIT_FAILURE);
             }
             break;
+        case 'b':
+            iterations = std::strtol(optarg, &str_end, 10);
+            if (optarg == str_end || *str_end != '\0' || iterations < 1) {
+                std::cout << "error: number of benchmark iterations must be a positive number\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'f':
+            if (std::strcmp(optarg, "text") == 0)
+                format = Format::Text;
+            else if (std::strcmp(optarg, "json") == 0)
+                format = Format::Json;
+            else if (std::strcmp(optarg, "csv") == 0)
+                format = Format::Csv;
+            else {
+                std::cout << "error: format must be one of text, json or csv\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'c': counters = true; break;
+        case 't':
+            if (!trace_enabled) {
+                std::cout << "error: tracing needs a build configured with -DAOC_TRACING=ON\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            trace_path = optarg;
+            break;
+        case 'C': cache_dir = optarg; break;
+        case 'r': rebuild_cache = true; break;
+        case 'M': memo_dir = optarg; break;
+        case 'a':
+            if (std::strcmp(optarg, "use") == 0)
+                memo_mode = MemoMode::Use;
+            else if (std::strcmp(optarg, "bypass") == 0)
+                memo_mode = MemoMode::Bypass;
+            else if (std::strcmp(optarg, "verify") == 0)
+                memo_mode = MemoMode::Verify;
+            else if (std::strcmp(optarg, "clear") == 0)
+                memo_mode = MemoMode::Clear;
+            else {
+                std::cout << "error: mode must be one of use, bypass, verify or clear\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'l': manifest_path = optarg; break;
+        case 'S': socket_path = optarg; break;
+        case 'm':
+            cache_capacity = parse_size(optarg);
+            if (!cache_capacity) {
+                std::cout << "error: cache size must be a positive number of bytes\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'j': {
+            // Far more than any machine this runs on has, but few enough that making the pools can't exhaust memory
+            constexpr long max_threads = 1024;
+            errno = 0;
+            const auto threads = std::strtol(optarg, &str_end, 10);
+            if (optarg == str_end || *str_end != '\0' || errno == ERANGE || threads < 1 || threads > max_threads) {
+                std::cout << "error: number of threads must be a positive number, at most " << max_threads << '\n';
+                usage(progname, EXIT_FAILURE);
+            }
+            thread_pool::set_default_size(static_cast<unsigned>(threads));
+            break;
+        }
+        case WatchOption: watch = true; break;
+        case EngineOption: {
+            std::optional<engine> e;
+            if (!parse_engine(optarg, e)) {
+                std::cout << "error: engine must be one of auto, reference, serial or parallel\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            select_engine(e);
+            break;
+        }
+        case CrossCheckOption: set_cross_checking(true); break;
+        case TuneOption: tune = true; break;
+        case ScalingOption: scaling = true; break;
+        case ThreadScalingOption: thread_scaling = true; break;
         case 'h': usage(progname, EXIT_SUCCESS); // fallthrough because this function never returns
         default: /* '?' */ usage(progname, EXIT_FAILURE);
         }
     }
 
+    // The kernels have picked their variants already, so a level that doesn't exist can only be complained about now
+    simd_level forced_level;
+    if (const auto *const level = std::getenv("AOC_CPU_LEVEL"); level && !parse_simd_level(level, forced_level)) {
+        std::cout << "error: AOC_CPU_LEVEL must be one of scalar, sse2, sse4.2, avx2 or avx512\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    if (socket_path)
+        return run_server(socket_path, cache_capacity);
+
+    if (memo_mode != MemoMode::Use && !memo_dir) {
+        std::cout << "error: -a needs an answer directory given with -M\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    std::optional<answer_memo> memo;
+    if (memo_dir) {
+        // Any change to any day changes the executable, so hashing it is a cheap and safe stand-in for a version
+        const mapped_file self{"/proc/self/exe"};
+        if (!self) {
+            std::cout << "error: can't remember answers without being able to read /proc/self/exe" << std::endl;
+            return EXIT_FAILURE;
+        }
+        memo.emplace(answer_memo{binary_cache{memo_dir, ".part1"}, binary_cache{memo_dir, ".part2"},
+                                 hash_bytes(self.view()), memo_mode});
+        if (memo_mode == MemoMode::Clear) {
+            const auto n = memo->part1.clear() + memo->part2.clear();
+            std::cout << "cleared " << n << " remembered answers" << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+    const auto *const memo_ptr = memo ? &*memo : nullptr;
+
     if (day == -1) {
         std::cout << "error: missing option -- 'd'\n";
         usage(progname, EXIT_FAILURE);
     }
 
-    if (optind >= argc) {
-        std::cout << "error: missing path to puzzle input\n";
+    if (iterations && day == ALL_DAYS) {
+        std::cout << "error: benchmarking needs a single day\n";
         usage(progname, EXIT_FAILURE);
     }
 
-    const char *const input_path = argv[optind];
-    std::ifstream input{input_path};
-    if (!input) {
-        std::cout << "error: opening " << input_path << " failed." << std::endl;
+    // Keep machine-readable benchmark output free of anything else
+    if (!iterations || format == Format::Text)
+        std::cout << "This is the Advent of Code 2024\n";
+
+    std::vector<std::string> input_paths{argv + optind, argv + argc};
+    if (manifest_path && !read_manifest(manifest_path, input_paths)) {
+        std::cout << "error: opening " << manifest_path << " failed." << std::endl;
         return EXIT_FAILURE;
     }
 
-    return run_aoc(day, part, input);
+    const auto generated = scaling || thread_scaling;
+    if (generated &&
+        (!input_paths.empty() || iterations || counters || watch || tune || cache_dir || memo_dir ||
+         (scaling && thread_scaling))) {
+        std::cout << "error: --scaling and --thread-scaling generate their own inputs, and can't be combined with each"
+                     " other, input files, -b, -c, -C, -M, --watch or --tune\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    if (thread_scaling && day == ALL_DAYS) {
+        std::cout << "error: --thread-scaling needs a single day\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    if (input_paths.empty() && !generated) {
+        std::cout << "error: missing path to puzzle input\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    const auto batch = manifest_path || input_paths.size() > 1;
+    if (batch && (day == ALL_DAYS || iterations || counters)) {
+        std::cout << "error: -d all, -b and -c need a single input\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    const auto stream = std::find(std::begin(input_paths), std::end(input_paths), "-") != std::end(input_paths);
+    if (stream && (batch || day == ALL_DAYS || iterations || counters || cache_dir || memo_dir)) {
+        std::cout << "error: reading input from stdin can't be combined with other inputs, -d all, -b, -c, -C or -M\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    if (tune && (stream || watch || day == ALL_DAYS || iterations || counters)) {
+        std::cout << "error: --tune needs a single day and input files, and can't be combined with -b, -c or --watch\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    if (watch && (batch || stream || day == ALL_DAYS || iterations || counters || trace_path)) {
+        std::cout << "error: --watch needs a single input file and can't be combined with -d all, -b, -c or -t\n";
+        usage(progname, EXIT_FAILURE);
+    }
+
+    if (rebuild_cache && !cache_dir) {
+        std::cout << "error: -r needs a cache directory given with -C\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    std::optional<parse_cache> cache;
+    if (cache_dir)
+        cache.emplace(parse_cache{binary_cache{cache_dir}, rebuild_cache});
+    const auto *const cache_ptr = cache ? &*cache : nullptr;
+
+    auto ret = EXIT_SUCCESS;
+    if (scaling) {
+        ret = scaling_aoc(day, part);
+    } else if (thread_scaling) {
+        ret = thread_scaling_aoc(day, part);
+    } else if (tune) {
+        ret = tune_aoc(day, part, input_paths, cache_ptr);
+    } else if (day == ALL_DAYS) {
+        ret = run_all(part, input_paths.front(), counters, cache_ptr, memo_ptr);
+    } else if (batch) {
+        ret = run_batch(day, part, input_paths, cache_ptr, memo_ptr);
+    } else if (stream) {
+        ret = stream_aoc(day, part);
+    } else if (watch) {
+        ret = watch_aoc(day, part, input_paths.front(), cache_ptr, memo_ptr);
+    } else {
+        const char *const input_path = input_paths.front().c_str();
+        const mapped_file input{input_path};
+        if (!input) {
+            std::cout << "error: opening " << input_path << " failed." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (iterations)
+            ret = bench_aoc(day, part, input, iterations, format, cache_ptr);
+        else
+            ret = run_aoc(day, part, input, counters, cache_ptr, memo_ptr);
+    }
+
+    if (trace_path && !write_trace(trace_path)) {
+        std::cout << "error: writing trace to " << trace_path << " failed." << std::endl;
+        ret = EXIT_FAILURE;
+    }
+
+    return ret;
 }
@@ -0,0 +1,206 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <optional>
+
+#include "days/days.h"
+#include "gen/inputs.h"
+#include "util/arena.h"
+#include "util/engine.h"
+#include "util/mapped_file.h"
+using namespace aoc;
+using namespace aoc::gen;
+
+#define OPTSTRING "hd:n:w:s:o:A:"
+
+enum long_option {
+    WorstCaseOption = 256,
+    EngineOption,
+};
+
+static const option LONG_OPTIONS[] = {
+    {"worst-case", no_argument, nullptr, WorstCaseOption},
+    {"engine", required_argument, nullptr, EngineOption},
+    {nullptr, 0, nullptr, 0},
+};
+
+#define HELP_MESSAGE                                                                                 \
+    "[ -h ] | -d DAY [ -n SCALE ] [ -w WIDTH ] [ -s SEED ] [ -o FILE [ -A FILE ] ]\n"                \
+    "         [ --worst-case ] [ --engine=NAME ]\n\n"                                                \
+    "Writes a well-formed puzzle input for DAY of any size, to stdout or to FILE. The same day,\n"   \
+    "scale, width and seed always give the same input.\n\n"                                          \
+    "    -h        display this help message and exit\n"                                             \
+    "    -d DAY    which day's input to generate\n"                                                  \
+    "    -n SCALE  how big an input to generate, counted as listed below for each day\n"             \
+    "    -w WIDTH  the most items in one record, for the days whose records vary in length\n"        \
+    "    -s SEED   seed for the random choices (default 1)\n"                                        \
+    "    -o FILE   write the input to FILE rather than to stdout\n"                                  \
+    "    -A FILE   also solve the input written with -o and write its answers to FILE, one line\n"   \
+    "              per part as aoc2024 prints them\n"                                                \
+    "    --worst-case  generate an input aimed at the worst case of the day's solvers rather\n"      \
+    "              than a realistic one, for the days marked * below\n"                              \
+    "    --engine=NAME  which implementation solves the parts that have several for -A: reference\n" \
+    "              (the default), serial, parallel or auto; day 7's reference engine takes hours\n"  \
+    "              on equations of 20 or more operands\n\n"                                          \
+    "Days, and what SCALE and WIDTH count for them (with their defaults, which are roughly the\n"    \
+    "size of the real puzzle inputs):"
+
+static void usage(const char *progname, int exit_code) {
+    std::cout << "usage: " << progname << ' ' << HELP_MESSAGE << '\n';
+    for (std::size_t i = 0; i < generator_count; i++) {
+        const auto &g = generators[i];
+        std::cout << "    " << g.day << (g.write_worst_case ? "* " : "  ") << g.scale_meaning << " ("
+                  << g.default_scale;
+        if (g.max_scale)
+            std::cout << ", at most " << g.max_scale;
+        std::cout << ')';
+        if (g.default_width)
+            std::cout << ", " << g.width_meaning << " (" << g.default_width << ')';
+        std::cout << '\n';
+    }
+    std::cout << std::flush;
+    std::exit(exit_code);
+}
+
+// Parses input_path as a day's input and writes the answers to answers_path, the way aoc2024 would print them
+template <class Day>
+static bool write_answers(const char *input_path, const char *answers_path) {
+    const mapped_file input{input_path};
+    if (!input) {
+        std::cerr << "error: opening " << input_path << " failed." << std::endl;
+        return false;
+    }
+    std::ofstream answers{answers_path};
+    if (!answers) {
+        std::cerr << "error: opening " << answers_path << " failed." << std::endl;
+        return false;
+    }
+
+    const arena_scope arena;
+    auto parsed = Day::parse(input);
+    answers << Day::part1(parsed) << '\n';
+    if constexpr (Day::has_part2)
+        answers << Day::part2(parsed) << '\n';
+    answers.close();
+    if (!answers) {
+        std::cerr << "error: writing " << answers_path << " failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool parse_number(const char *s, std::uint64_t &n) {
+    char *end;
+    n = std::strtoull(s, &end, 10);
+    return end != s && *end == '\0' && *s != '-';
+}
+
+int main(int argc, char *argv[]) {
+    const char *const progname = argv[0];
+    int opt;
+    const generator *gen = nullptr;
+    std::optional<std::uint64_t> scale, width;
+    std::uint64_t seed = 1;
+    const char *output_path = nullptr, *answers_path = nullptr;
+    std::optional<engine> answers_engine = engine::Reference;
+    auto worst_case = false;
+
+    while ((opt = getopt_long(argc, argv, OPTSTRING, LONG_OPTIONS, nullptr)) != -1) {
+        std::uint64_t n;
+        switch (opt) {
+        case 'd':
+            if (!parse_number(optarg, n) || !(gen = find_generator(static_cast<long>(n)))) {
+                std::cerr << "error: day must be one that has a generator\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'n':
+            if (!parse_number(optarg, n) || n < 1) {
+                std::cerr << "error: scale must be a positive number\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            scale = n;
+            break;
+        case 'w':
+            if (!parse_number(optarg, n) || n < 1) {
+                std::cerr << "error: width must be a positive number\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            width = n;
+            break;
+        case 's':
+            if (!parse_number(optarg, seed)) {
+                std::cerr << "error: seed must be a number\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'o': output_path = optarg; break;
+        case 'A': answers_path = optarg; break;
+        case WorstCaseOption: worst_case = true; break;
+        case EngineOption:
+            if (!parse_engine(optarg, answers_engine)) {
+                std::cerr << "error: engine must be one of auto, reference, serial or parallel\n";
+                usage(progname, EXIT_FAILURE);
+            }
+            break;
+        case 'h': usage(progname, EXIT_SUCCESS); // fallthrough because this function never returns
+        default: /* '?' */ usage(progname, EXIT_FAILURE);
+        }
+    }
+
+    if (!gen) {
+        std::cerr << "error: missing option -- 'd'\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    if (answers_path && !output_path) {
+        std::cerr << "error: -A needs the input written to a file with -o\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    if (worst_case && !gen->write_worst_case) {
+        std::cerr << "error: day " << gen->day << " has no worst-case generator\n";
+        usage(progname, EXIT_FAILURE);
+    }
+    const auto write = worst_case ? gen->write_worst_case : gen->write;
+
+    const options opts{scale.value_or(gen->default_scale), width.value_or(gen->default_width), seed};
+    if (gen->max_scale && opts.scale > gen->max_scale) {
+        std::cerr << "error: day " << gen->day << "'s scale can be at most " << gen->max_scale << '\n';
+        usage(progname, EXIT_FAILURE);
+    }
+    if (output_path) {
+        std::ofstream out{output_path, std::ios::binary};
+        if (!out) {
+            std::cerr << "error: opening " << output_path << " failed." << std::endl;
+            return EXIT_FAILURE;
+        }
+        write(out, opts);
+        out.close();
+        if (!out) {
+            std::cerr << "error: writing " << output_path << " failed." << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::ios::sync_with_stdio(false);
+        write(std::cout, opts);
+        std::cout.flush();
+    }
+
+    if (answers_path) {
+        select_engine(answers_engine);
+        auto ok = false;
+        try {
+            with_day(gen->day, [output_path, answers_path, &ok](auto d) {
+                ok = write_answers<decltype(d)>(output_path, answers_path);
+            });
+        } catch (const std::exception &e) {
+            std::cerr << "error: " << e.what() << std::endl;
+        }
+        if (!ok)
+            return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
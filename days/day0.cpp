@@ -1,19 +1,19 @@
 #include <numeric>
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 #include "day0.h"
+#include "scan.h"
 
 namespace aoc::day0 {
 
-Input parse_input(std::ifstream &input) {
+Input parse_input(std::string_view input) {
     Input is;
-
-    for (Input::value_type n; input >> n;)
-        is.push_back(n);
-
+    scan_all(input, is);
     return is;
 }
 
@@ -34,7 +34,7 @@ TEST_CASE("day 0", "[day0]") {
     const Input input{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day0-input.txt"};
+        const mapped_file input_fixture{"fixtures/day0-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -53,4 +53,24 @@ TEST_CASE("day 0", "[day0]") {
 }
 #endif
 
+#ifdef BENCHMARKING
+TEST_CASE("day 0", "[day0]") {
+    const mapped_file input_fixture{"fixtures/day0-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+}
+#endif
+
 } // namespace aoc::day0
@@ -1,5 +1,5 @@
 #include <cstdint>
-#include <fstream>
+#include <string_view>
 #include <vector>
 
 #pragma once
@@ -10,7 +10,7 @@ using Input = std::vector<std::uint32_t>;
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &is);
 
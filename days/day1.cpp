@@ -3,33 +3,32 @@
 #include <cstdlib>
 #include <set>
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 #include "day1.h"
+#include "line_index.h"
+#include "scan.h"
 
 namespace aoc::day1 {
 
 Input::Input(Input &&input) : left{std::move(input.left)}, right{std::move(input.right)} {}
 
-Input parse_input(std::ifstream &input) {
+Input parse_input(std::string_view input) {
     Input lists;
+    const line_index lines{input};
+    lists.left.reserve(lines.size());
+    lists.right.reserve(lines.size());
 
-    enum {
-        LEFT,
-        RIGHT
-    } which = LEFT;
-
-    for (std::uint32_t i; input >> i;) {
-        switch (which) {
-        case LEFT:
-            lists.left.push_back(i);
-            which = RIGHT;
-            break;
-        case RIGHT: lists.right.push_back(i); which = LEFT;
-        }
-    }
+    // Every number in one go, then dealt out alternately to the left and right lists
+    std::vector<std::uint32_t> numbers;
+    numbers.reserve(2 * lines.size());
+    scan_all(input, numbers);
+    for (std::size_t i = 0; i < numbers.size(); i++)
+        (i % 2 ? lists.right : lists.left).push_back(numbers[i]);
 
     assert(lists.left.size() == lists.right.size());
     return lists;
@@ -63,7 +62,7 @@ TEST_CASE("day 1 sample", "[day1][sample]") {
     input.right = {4, 3, 5, 3, 9, 3};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day1-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day1-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -83,7 +82,7 @@ TEST_CASE("day 1 sample", "[day1][sample]") {
 }
 
 TEST_CASE("day 1", "[day1]") {
-    std::ifstream input_fixture{"fixtures/day1-input.txt"};
+    const mapped_file input_fixture{"fixtures/day1-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -100,4 +99,30 @@ TEST_CASE("day 1", "[day1]") {
 }
 #endif
 
+#ifdef BENCHMARKING
+TEST_CASE("day 1", "[day1]") {
+    const mapped_file input_fixture{"fixtures/day1-input.txt"};
+    REQUIRE(input_fixture);
+    auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    // part1() sorts the lists, so every run gets a fresh copy to sort
+    BENCHMARK_ADVANCED("part1")(Catch::Benchmark::Chronometer meter) {
+        std::vector<Input> inputs;
+        for (auto i = 0; i < meter.runs(); i++)
+            inputs.push_back(parse_input(input_fixture));
+        meter.measure([&inputs](int i) {
+            return part1(inputs[i]);
+        });
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+}
+#endif
+
 } // namespace aoc::day1
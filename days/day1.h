@@ -1,5 +1,5 @@
 #include <cstdint>
-#include <fstream>
+#include <string_view>
 #include <vector>
 
 #pragma once
@@ -16,7 +16,7 @@ struct Input {
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(Input &lists);
 Part2Output part2(Input &lists);
@@ -1,34 +1,50 @@
-#include <array>
 #include <cstdlib>
-#include <sstream>
-#include <string>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define DAY2_X86
+#endif
+
+#include "cpu_dispatch.h"
 #include "day2.h"
+#include "line_index.h"
+#include "parallel.h"
+#include "scan.h"
 
 namespace aoc::day2 {
 
-Input parse_input(std::ifstream &input) {
-    Input reports;
-
-    for (std::string report_string; std::getline(input, report_string);) {
-        Input::value_type report;
-        std::istringstream report_stringstream{report_string};
-        for (std::array<char, 3> level_string; report_stringstream.getline(&level_string[0], 3, ' ');) {
-            Input::value_type::value_type level{std::atol(level_string.data())};
-            report.push_back(level);
+Input parse_input(std::string_view input) {
+    const line_index lines{input};
+    return parse_narrowest<Reports>([input, &lines](auto width) {
+        using Level = typename decltype(width)::type;
+        Reports<Level> reports;
+        // Every level takes at least two bytes, a digit and the space or newline after it, so this is (just about)
+        // enough
+        reports.reserve(lines.size(), input.size() / 2);
+
+        for (std::size_t i = 0; i < lines.size(); i++) {
+            scanner s{lines.line(i)};
+            for (Level level; s.next(level);)
+                reports.push_back(level);
+            reports.end_row();
         }
 
-        reports.emplace_back(std::move(report));
-    }
-
-    return reports;
+        return reports;
+    });
 }
 
-static bool is_safe(const Input::value_type &report) {
+template <class Level>
+static bool is_safe(typename Reports<Level>::row report) {
     bool increase;
 
     for (auto it = std::cbegin(report); it != std::cend(report) - 1; it++) {
@@ -97,15 +113,16 @@ static bool is_safe_with_problem_dampener(const Input::value_type &report) {
 }
 #endif
 
-static bool is_safe_with_problem_dampener(const Input::value_type &reports) {
-    if (is_safe(reports))
+template <class Level>
+static bool is_safe_with_problem_dampener(typename Reports<Level>::row reports) {
+    if (is_safe<Level>(reports))
         return true;
 
-    Input::value_type rs{reports};
+    std::vector<Level> rs(std::begin(reports), std::end(reports));
     for (auto it = std::begin(rs); it != std::end(rs); it++) {
         const auto e{*it};
         rs.erase(it);
-        if (is_safe(rs))
+        if (is_safe<Level>(rs))
             return true;
         rs.insert(it, e);
     }
@@ -113,62 +130,211 @@ static bool is_safe_with_problem_dampener(const Input::value_type &reports) {
     return false;
 }
 
-template <bool (*safety_func)(const Input::value_type &)>
-static std::uint32_t determine_safety(const Input &reports) {
+// The kernels count the safe reports among reports [first, last)
+template <class Level, bool dampened>
+static std::uint32_t count_safe_scalar(const Reports<Level> &reports, std::size_t first, std::size_t last) {
     std::uint32_t safe{0};
 
-    for (const auto &report : reports)
-        if (safety_func(report))
+    for (auto i = first; i < last; i++)
+        if (dampened ? is_safe_with_problem_dampener<Level>(reports[i]) : is_safe<Level>(reports[i]))
             safe++;
 
     return safe;
 }
 
+#ifdef DAY2_X86
+// Byte-sized levels, which is what nearly every report has, are checked a whole report at a time in one SSE2 register:
+// the steps between neighbours are worked out in every lane at once, and the report is safe if every step is, going
+// the same way. The problem dampener removes each level in turn by shifting the lanes above it down one.
+
+// Whether the first n (at most 16) levels make a safe report
+__attribute__((target("sse2"))) static bool is_safe_sse2(__m128i levels, unsigned n) {
+    const auto next = _mm_srli_si128(levels, 1);
+    // Saturating differences are 0 for a step the other way, which, like a step of more than 3, doesn't land in 1-3
+    const auto up = _mm_sub_epi8(_mm_subs_epu8(next, levels), _mm_set1_epi8(1)),
+               down = _mm_sub_epi8(_mm_subs_epu8(levels, next), _mm_set1_epi8(1));
+    const auto two = _mm_set1_epi8(2);
+    const unsigned safe_up = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(up, two), up)),
+                   safe_down = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(down, two), down));
+    const auto steps = (1U << (n - 1)) - 1;
+    return (safe_up & steps) == steps || (safe_down & steps) == steps;
+}
+
+__attribute__((target("sse2"))) static bool is_safe_with_problem_dampener_sse2(__m128i levels, unsigned n) {
+    if (is_safe_sse2(levels, n))
+        return true;
+
+    const auto lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const auto shifted = _mm_srli_si128(levels, 1);
+    for (unsigned i = 0; i < n; i++) {
+        const auto below = _mm_cmplt_epi8(lane, _mm_set1_epi8(static_cast<char>(i)));
+        if (is_safe_sse2(_mm_or_si128(_mm_and_si128(below, levels), _mm_andnot_si128(below, shifted)), n - 1))
+            return true;
+    }
+    return false;
+}
+
+template <bool dampened>
+__attribute__((target("sse2"))) static std::uint32_t
+count_safe_sse2(const Reports<std::uint8_t> &reports, std::size_t first_report, std::size_t last_report) {
+    const auto &values = reports.values();
+    const auto &offsets = reports.offsets();
+    std::uint32_t safe{0};
+
+    for (auto i = first_report; i < last_report; i++) {
+        const auto first = offsets[i], n = offsets[i + 1] - first;
+        if (n > 16 || n == 0) {
+            const auto report = reports[i];
+            safe += dampened ? is_safe_with_problem_dampener<std::uint8_t>(report) : is_safe<std::uint8_t>(report);
+            continue;
+        }
+
+        __m128i levels;
+        if (first + 16 <= values.size()) {
+            levels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values.data() + first));
+        } else {
+            // The last few reports, where a whole register's worth would read past the end of the levels
+            alignas(16) std::uint8_t padded[16] = {};
+            std::memcpy(padded, values.data() + first, n);
+            levels = _mm_load_si128(reinterpret_cast<const __m128i *>(padded));
+        }
+        safe += dampened ? is_safe_with_problem_dampener_sse2(levels, n) : is_safe_sse2(levels, n);
+    }
+
+    return safe;
+}
+#endif
+
+using count_safe_fn = std::uint32_t(const Reports<std::uint8_t> &, std::size_t, std::size_t);
+
+static const simd_kernel<count_safe_fn> count_safe{
+    {simd_level::Scalar, count_safe_scalar<std::uint8_t, false>},
+#ifdef DAY2_X86
+    {simd_level::SSE2, count_safe_sse2<false>},
+#endif
+};
+
+static const simd_kernel<count_safe_fn> count_safe_with_problem_dampener{
+    {simd_level::Scalar, count_safe_scalar<std::uint8_t, true>},
+#ifdef DAY2_X86
+    {simd_level::SSE2, count_safe_sse2<true>},
+#endif
+};
+
+// Counts the safe reports among [first, last), with the problem dampener if dampened, vectorised where the levels fit
+template <class Level, bool dampened>
+static std::uint32_t count_safe_fastest(const Reports<Level> &reports, std::size_t first, std::size_t last) {
+    if constexpr (std::is_same_v<Level, std::uint8_t>)
+        return dampened ? count_safe_with_problem_dampener(reports, first, last) : count_safe(reports, first, last);
+    else
+        return count_safe_scalar<Level, dampened>(reports, first, last);
+}
+
+template <bool dampened>
+static std::uint32_t reference_safety(const Input &input) {
+    return std::visit(
+        [](const auto &reports) {
+            using Level = typename std::decay_t<decltype(reports)>::row::value_type;
+            return count_safe_scalar<Level, dampened>(reports, 0, reports.size());
+        },
+        input);
+}
+
+template <bool dampened>
+static std::uint32_t serial_safety(const Input &input) {
+    return std::visit(
+        [](const auto &reports) {
+            using Level = typename std::decay_t<decltype(reports)>::row::value_type;
+            return count_safe_fastest<Level, dampened>(reports, 0, reports.size());
+        },
+        input);
+}
+
+// Reports are independent, so they are shared out between threads a few hundred at a time
+template <bool dampened>
+static std::uint32_t parallel_safety(const Input &input) {
+    return std::visit(
+        [](const auto &reports) {
+            using Level = typename std::decay_t<decltype(reports)>::row::value_type;
+            return parallel_reduce(
+                0, reports.size(), 256, std::uint32_t{0},
+                [&reports](std::uint32_t &safe, std::size_t first, std::size_t last) {
+                    safe += count_safe_fastest<Level, dampened>(reports, first, last);
+                },
+                [](std::uint32_t a, std::uint32_t b) {
+                    return a + b;
+                });
+        },
+        input);
+}
+
+static std::size_t report_count(const Input &input) {
+    return std::visit(
+        [](const auto &reports) {
+            return reports.size();
+        },
+        input);
+}
+
+const engine_set<Input, Part1Output> part1_engines{"day 2 part 1",
+                                                   "reports",
+                                                   report_count,
+                                                   {{engine::Reference, reference_safety<false>},
+                                                    {engine::Serial, serial_safety<false>},
+                                                    {engine::Parallel, parallel_safety<false>, 20000}}};
+
+const engine_set<Input, Part2Output> part2_engines{"day 2 part 2",
+                                                   "reports",
+                                                   report_count,
+                                                   {{engine::Reference, reference_safety<true>},
+                                                    {engine::Serial, serial_safety<true>},
+                                                    {engine::Parallel, parallel_safety<true>, 5000}}};
+
 Part1Output part1(const Input &reports) {
-    return determine_safety<is_safe>(reports);
+    return part1_engines(reports);
 }
 
 Part2Output part2(const Input &reports) {
-    return determine_safety<is_safe_with_problem_dampener>(reports);
+    return part2_engines(reports);
 }
 
 #ifdef TESTING
 TEST_CASE("day 2 is_safe helper function", "[day2]") {
-    REQUIRE(is_safe({7, 6, 4, 2, 1}));
-    REQUIRE(!is_safe({1, 2, 7, 8, 9}));
-    REQUIRE(!is_safe({9, 7, 6, 2, 1}));
-    REQUIRE(!is_safe({1, 3, 2, 4, 5}));
-    REQUIRE(!is_safe({8, 6, 4, 4, 1}));
-    REQUIRE(is_safe({1, 3, 6, 7, 9}));
+    REQUIRE(is_safe<std::uint8_t>({7, 6, 4, 2, 1}));
+    REQUIRE(!is_safe<std::uint8_t>({1, 2, 7, 8, 9}));
+    REQUIRE(!is_safe<std::uint8_t>({9, 7, 6, 2, 1}));
+    REQUIRE(!is_safe<std::uint8_t>({1, 3, 2, 4, 5}));
+    REQUIRE(!is_safe<std::uint8_t>({8, 6, 4, 4, 1}));
+    REQUIRE(is_safe<std::uint8_t>({1, 3, 6, 7, 9}));
 }
 
 TEST_CASE("day 2 is_safe_with_problem_dampener helper function", "[day2]") {
-    REQUIRE(is_safe_with_problem_dampener({7, 6, 4, 2, 1}));
-    REQUIRE(!is_safe_with_problem_dampener({1, 2, 7, 8, 9}));
-    REQUIRE(!is_safe_with_problem_dampener({9, 7, 6, 2, 1}));
-    REQUIRE(is_safe_with_problem_dampener({1, 3, 2, 4, 5}));
-    REQUIRE(is_safe_with_problem_dampener({8, 6, 4, 4, 1}));
-    REQUIRE(is_safe_with_problem_dampener({1, 3, 6, 7, 9}));
-    REQUIRE(is_safe_with_problem_dampener({1, 1, 2, 3, 4}));
-    REQUIRE(is_safe_with_problem_dampener({1, 2, 3, 4, 4}));
-    REQUIRE(is_safe_with_problem_dampener({1, 3, 5, 6, 8, 9, 13, 10}));
-    REQUIRE(is_safe_with_problem_dampener({4, 1, 2, 5, 7, 9}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({7, 6, 4, 2, 1}));
+    REQUIRE(!is_safe_with_problem_dampener<std::uint8_t>({1, 2, 7, 8, 9}));
+    REQUIRE(!is_safe_with_problem_dampener<std::uint8_t>({9, 7, 6, 2, 1}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({1, 3, 2, 4, 5}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({8, 6, 4, 4, 1}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({1, 3, 6, 7, 9}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({1, 1, 2, 3, 4}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({1, 2, 3, 4, 4}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({1, 3, 5, 6, 8, 9, 13, 10}));
+    REQUIRE(is_safe_with_problem_dampener<std::uint8_t>({4, 1, 2, 5, 7, 9}));
 }
 
 TEST_CASE("day 2 sample", "[day2][sample]") {
     // clang-format off: want to keep this matrix-style formatting
-    const Input input{
+    const Input input{Reports<std::uint8_t>{
         {7, 6, 4, 2, 1},
         {1, 2, 7, 8, 9},
         {9, 7, 6, 2, 1},
         {1, 3, 2, 4, 5},
         {8, 6, 4, 4, 1},
         {1, 3, 6, 7, 9}
-    };
+    }};
     // clang-format on
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day2-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day2-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -184,10 +350,17 @@ TEST_CASE("day 2 sample", "[day2][sample]") {
         const auto expected = 4U, actual = part2(input);
         REQUIRE(expected == actual);
     }
+
+    SECTION("levels too big for a byte are stored wider") {
+        const auto parsed_input{parse_input("7 6 4 2 1\n1000 1002 1005\n")};
+        REQUIRE(std::holds_alternative<Reports<std::uint16_t>>(parsed_input));
+        CHECK(part1(parsed_input) == 2U);
+        CHECK(std::holds_alternative<Reports<std::uint32_t>>(parse_input("70000 70001\n")));
+    }
 }
 
 TEST_CASE("day 2", "[day2]") {
-    std::ifstream input_fixture{"fixtures/day2-input.txt"};
+    const mapped_file input_fixture{"fixtures/day2-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -201,6 +374,86 @@ TEST_CASE("day 2", "[day2]") {
         const auto expected = 717U, actual = part2(input);
         REQUIRE(expected == actual);
     }
+
+    SECTION("every variant the CPU can run agrees") {
+        const auto &reports = std::get<Reports<std::uint8_t>>(input);
+        for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+            const auto level = static_cast<simd_level>(i);
+            INFO("level " << simd_level_name(level));
+            CHECK(count_safe.variant(level)(reports, 0, reports.size()) == 686U);
+            CHECK(count_safe_with_problem_dampener.variant(level)(reports, 0, reports.size()) == 717U);
+        }
+    }
+
+    SECTION("every engine agrees") {
+        for (std::size_t i = 0; i < engine_count; i++) {
+            const auto e = static_cast<engine>(i);
+            INFO(engine_name(e) << " engine");
+            CHECK(part1_engines.variant(e)(input) == 686U);
+            CHECK(part2_engines.variant(e)(input) == 717U);
+        }
+    }
+}
+
+TEST_CASE("day 2 reports of every length", "[day2]") {
+    // Up to and past a register's worth of levels, and reports right at the end of the levels where a whole register
+    // can't be loaded
+    Reports<std::uint8_t> reports;
+    for (std::uint8_t n = 1; n <= 20; n++) {
+        for (std::uint8_t bad = 0; bad <= n; bad++) {
+            for (std::uint8_t l = 0; l < n; l++)
+                reports.push_back(l == bad ? 200 : 10 + 2 * l);
+            reports.end_row();
+            for (std::uint8_t l = 0; l < n; l++)
+                reports.push_back(l == bad ? 0 : 100 - 3 * l);
+            reports.end_row();
+        }
+    }
+
+    const auto n = reports.size();
+    const auto expected = count_safe_scalar<std::uint8_t, false>(reports, 0, n),
+               expected_dampened = count_safe_scalar<std::uint8_t, true>(reports, 0, n);
+    for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+        const auto level = static_cast<simd_level>(i);
+        INFO("level " << simd_level_name(level));
+        CHECK(count_safe.variant(level)(reports, 0, n) == expected);
+        CHECK(count_safe_with_problem_dampener.variant(level)(reports, 0, n) == expected_dampened);
+        // Split anywhere, the two halves add up to the whole
+        CHECK(count_safe.variant(level)(reports, 0, n / 3) + count_safe.variant(level)(reports, n / 3, n) == expected);
+    }
+}
+#endif
+
+#ifdef BENCHMARKING
+TEST_CASE("day 2", "[day2]") {
+    const mapped_file input_fixture{"fixtures/day2-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+
+    const auto &reports = std::get<Reports<std::uint8_t>>(input);
+    std::size_t unsafe = 0;
+    while (is_safe<std::uint8_t>(reports[unsafe]))
+        unsafe++;
+
+    BENCHMARK("is_safe") {
+        return is_safe<std::uint8_t>(reports[0]);
+    };
+
+    BENCHMARK("is_safe_with_problem_dampener") {
+        return is_safe_with_problem_dampener<std::uint8_t>(reports[unsafe]);
+    };
 }
 #endif
 
@@ -1,18 +1,29 @@
 #include <cstdint>
-#include <fstream>
-#include <vector>
+#include <string_view>
+
+#include "engine.h"
+#include "jagged_array.h"
+#include "narrow.h"
 
 #pragma once
 
 namespace aoc::day2 {
 
-using Input = std::vector<std::vector<std::uint32_t>>;
+// Each report's levels, stored in the narrowest type that fits them all
+template <class Level>
+using Reports = jagged_array<Level>;
+using Input = narrow_variant<Reports>;
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &reports);
 Part2Output part2(const Input &reports);
 
+// The engines part1() and part2() choose between: checking one report at a time for reference, and the vectorised
+// kernels, on one thread or on the shared pool
+extern const engine_set<Input, Part1Output> part1_engines;
+extern const engine_set<Input, Part2Output> part2_engines;
+
 } // namespace aoc::day2
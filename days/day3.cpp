@@ -1,140 +1,97 @@
-#include <fstream>
+#include <charconv>
 #include <optional>
-#include <sstream>
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 #include "day3.h"
 
 namespace aoc::day3 {
 
-static std::optional<std::uint32_t> read_and_eval_mul(std::istream &input) {
-    std::uint32_t a, b;
-    std::ifstream::int_type c;
+// If input has token at position i then skip over it and return true, otherwise leave i alone and return false.
+static bool consume(std::string_view input, std::size_t &i, std::string_view token) {
+    if (input.compare(i, token.size(), token) != 0)
+        return false;
+    i += token.size();
+    return true;
+}
 
-    if ((c = input.get()) != 'm')
+static std::optional<std::uint32_t> read_number(std::string_view input, std::size_t &i) {
+    std::uint32_t n;
+    const auto [ptr, ec] = std::from_chars(input.data() + i, input.data() + input.size(), n);
+    if (ec != std::errc{})
         return std::nullopt;
+    i = ptr - input.data();
+    return n;
+}
 
-    if ((c = input.get()) != 'u')
-        return std::nullopt;
+// Only moves i past the instruction if there actually is a well-formed mul(X,Y) at position i.
+static std::optional<std::uint32_t> read_and_eval_mul(std::string_view input, std::size_t &i) {
+    auto j = i;
 
-    if ((c = input.get()) != 'l')
+    if (!consume(input, j, "mul("))
         return std::nullopt;
 
-    if ((c = input.get()) != '(')
+    const auto a = read_number(input, j);
+    if (!a)
         return std::nullopt;
 
-    input >> a;
-    if (input.fail())
+    if (!consume(input, j, ","))
         return std::nullopt;
 
-    if ((c = input.get()) != ',')
+    const auto b = read_number(input, j);
+    if (!b)
         return std::nullopt;
 
-    input >> b;
-    if (input.fail())
+    if (!consume(input, j, ")"))
         return std::nullopt;
 
-    if ((c = input.get()) != ')')
-        return std::nullopt;
+    i = j;
+    return *a * *b;
+}
 
-    return a * b;
+Input parse_input(std::string_view input) {
+    return input;
 }
 
-Part1Output part1(std::istream &input) {
-    auto sum{0};
+Part1Output part1(Input input) {
+    Part1Output sum{0};
 
-    while (!input.eof()) {
-        if (auto mul = read_and_eval_mul(input))
+    for (auto i = input.find("mul("); i != std::string_view::npos; i = input.find("mul(", i)) {
+        if (auto mul = read_and_eval_mul(input, i))
             sum += *mul;
+        else
+            i++;
     }
 
     return sum;
 }
 
-Part2Output part2(std::istream &input) {
-    auto sum{0};
-    std::uint32_t a, b;
-    std::istream::int_type c;
+Part2Output part2(Input input) {
+    Part2Output sum{0};
     auto enabled{true};
 
-loop:
-    while (!input.eof()) {
-        switch ((c = input.get())) {
+    for (std::size_t i = 0; i < input.size();) {
+        switch (input[i]) {
         case 'd':
-            if ((c = input.get()) != 'o') {
-                input.unget();
-                goto loop;
-            }
-
-            switch ((c = input.get())) {
-            case '(':
-                if ((c = input.get()) == ')')
-                    enabled = true;
-                else
-                    input.unget();
-                goto loop;
-            case 'n':
-                if ((c = input.get()) != '\'') {
-                    input.unget();
-                    goto loop;
-                }
-
-                if ((c = input.get()) != 't') {
-                    input.unget();
-                    goto loop;
-                }
-
-                if ((c = input.get()) != '(') {
-                    input.unget();
-                    goto loop;
-                }
-
-                if ((c = input.get()) == ')')
-                    enabled = false;
-                else
-                    input.unget();
-                goto loop;
-            default: input.unget(); goto loop;
-            }
+            if (consume(input, i, "do()"))
+                enabled = true;
+            else if (consume(input, i, "don't()"))
+                enabled = false;
+            else
+                i++;
+            break;
         case 'm':
-            if ((c = input.get()) != 'u') {
-                input.unget();
-                goto loop;
-            }
-
-            if ((c = input.get()) != 'l') {
-                input.unget();
-                goto loop;
-            }
-
-            if ((c = input.get()) != '(') {
-                input.unget();
-                goto loop;
-            }
-
-            input >> a;
-            if (input.fail())
-                goto loop;
-
-            if ((c = input.get()) != ',') {
-                input.unget();
-                goto loop;
-            }
-
-            input >> b;
-            if (input.fail())
-                goto loop;
-
-            if ((c = input.get()) != ')') {
-                input.unget();
-                goto loop;
-            }
-
-            if (enabled)
-                sum += a * b;
+            if (auto mul = read_and_eval_mul(input, i)) {
+                if (enabled)
+                    sum += *mul;
+            } else
+                i++;
+            break;
+        default: i++;
         }
     }
 
@@ -144,20 +101,20 @@ loop:
 #ifdef TESTING
 TEST_CASE("day 3 sample", "[day3][sample]") {
     SECTION("part 1") {
-        std::istringstream input{"xmul(2,4)%&mul[3,7]!@^do_not_mul(5,5)+mul(32,64]then(mul(11,8)mul(8,5))"};
+        const std::string_view input{"xmul(2,4)%&mul[3,7]!@^do_not_mul(5,5)+mul(32,64]then(mul(11,8)mul(8,5))"};
         const auto expected = 161U, actual = part1(input);
         REQUIRE(expected == actual);
     }
 
     SECTION("part 2") {
-        std::istringstream input{"xmul(2,4)&mul[3,7]!^don't()_mul(5,5)+mul(32,64](mul(11,8)undo()?mul(8,5))"};
+        const std::string_view input{"xmul(2,4)&mul[3,7]!^don't()_mul(5,5)+mul(32,64](mul(11,8)undo()?mul(8,5))"};
         const auto expected = 48U, actual = part2(input);
         REQUIRE(expected == actual);
     }
 }
 
 TEST_CASE("day 3", "[day3]") {
-    std::ifstream input{"fixtures/day3-input.txt"};
+    const mapped_file input{"fixtures/day3-input.txt"};
     REQUIRE(input);
 
     SECTION("part 1") {
@@ -172,4 +129,24 @@ TEST_CASE("day 3", "[day3]") {
 }
 #endif
 
+#ifdef BENCHMARKING
+TEST_CASE("day 3", "[day3]") {
+    const mapped_file input_fixture{"fixtures/day3-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+}
+#endif
+
 } // namespace aoc::day3
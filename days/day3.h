@@ -1,14 +1,18 @@
 #include <cstdint>
-#include <istream>
+#include <string_view>
 
 #pragma once
 
 namespace aoc::day3 {
 
+// Day 3 works straight off the raw program text
+using Input = std::string_view;
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Part1Output part1(std::istream &input);
-Part2Output part2(std::istream &input);
+Input parse_input(std::string_view input);
+
+Part1Output part1(Input input);
+Part2Output part2(Input input);
 
 } // namespace aoc::day3
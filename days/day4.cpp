@@ -1,30 +1,40 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "cpu_dispatch.h"
 #include "day4.h"
+#include "split.h"
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+#include <vector>
+
+#include "mapped_file.h"
 #endif
 
 namespace aoc::day4 {
 
-Input parse_input(std::ifstream &input) {
-    Input::size_type r{1}, c{0};
-    std::ifstream::int_type chr;
-    // Count number of columns
-    for (; (chr = input.get()) != '\n'; c++)
-        ;
-    // Count number of rows
-    while (input)
-        if ((chr = input.get()) == '\n')
-            r++;
-    // Now that we've determined the matrix dimensions, go back to the start and read in the matrix
-    input.clear(); // https://stackoverflow.com/a/28331018
-    input.seekg(0);
+Input parse_input(std::string_view input) {
+    // The number of columns is the length of the first line and the number of rows is the number of lines
+    const Input::size_type c = std::min(input.find('\n'), input.size()),
+                           r = std::count(std::cbegin(input), std::cend(input), '\n') +
+                               (!input.empty() && input.back() != '\n');
     Input m{r, c, '.'};
-    input >> m;
+    for (Input::size_type i = 0; i < r; i++) {
+        const auto line = next_token(input, '\n');
+        std::copy_n(std::cbegin(line), std::min(line.size(), c), m.data() + i * c);
+    }
     return m;
 }
 
-Part1Output part1(const Input &word_search) {
+namespace {
+
+Part1Output count_xmas_scalar(const Input &word_search) {
     Part1Output cnt{0};
 
     for (auto r = 0; r < word_search.rows(); r++) {
@@ -75,7 +85,7 @@ Part1Output part1(const Input &word_search) {
     return cnt;
 }
 
-Part2Output part2(const Input &word_search) {
+Part2Output count_x_mas_scalar(const Input &word_search) {
     Part2Output cnt{0};
 
     for (auto r = 1; r < word_search.rows() - 1; r++) {
@@ -116,6 +126,211 @@ Part2Output part2(const Input &word_search) {
     return cnt;
 }
 
+// The SSE2 and AVX2 variants compare a vector's width of cells at a time, written once with the compiler's generic
+// vectors and compiled for each instruction set by the target-specific functions below, into which they are inlined.
+// A comparison sets a lane to all ones (i.e. -1) where it matches.
+typedef signed char v16 __attribute__((vector_size(16)));
+typedef signed char v32 __attribute__((vector_size(32)));
+
+// Counts matches a lane at a time, emptying the lanes into a total before any of them can wrap
+template <class V>
+struct lane_counts {
+    V lanes{};
+    unsigned pending = 0;
+    std::uint32_t total = 0;
+
+    [[gnu::always_inline]] void add(V match) {
+        lanes -= match;
+        if (++pending == 255)
+            flush();
+    }
+
+    [[gnu::always_inline]] std::uint32_t flush() {
+        for (std::size_t i = 0; i < sizeof(V); i++)
+            total += static_cast<unsigned char>(lanes[i]);
+        lanes = V{};
+        pending = 0;
+        return total;
+    }
+};
+
+// Whether XMAS is spelt forwards or backwards from (r, c) in direction (dr, dc)
+bool xmas_at(const char *grid, std::ptrdiff_t cols, std::ptrdiff_t r, std::ptrdiff_t c, int dr, int dc) {
+    char word[4];
+    for (int k = 0; k < 4; k++)
+        word[k] = grid[(r + k * dr) * cols + c + k * dc];
+    return std::memcmp(word, "XMAS", 4) == 0 || std::memcmp(word, "SAMX", 4) == 0;
+}
+
+// Whether there are two MASes crossing at (r, c)
+bool x_mas_at(const char *grid, std::ptrdiff_t cols, std::ptrdiff_t r, std::ptrdiff_t c) {
+    const auto *const above = grid + (r - 1) * cols + c, *const below = grid + (r + 1) * cols + c;
+    const auto mas = [](char a, char b) {
+        return (a == 'M' && b == 'S') || (a == 'S' && b == 'M');
+    };
+    return grid[r * cols + c] == 'A' && mas(above[-1], below[1]) && mas(above[1], below[-1]);
+}
+
+// Looking for XMAS forwards and backwards in four directions covers the eight the scalar version looks in
+template <class V>
+[[gnu::always_inline]] inline Part1Output count_xmas_vector(const Input &word_search) {
+    constexpr std::ptrdiff_t w = sizeof(V);
+    constexpr int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    const std::ptrdiff_t rows = word_search.rows(), cols = word_search.cols();
+    const auto *const grid = word_search.data();
+
+    lane_counts<V> cnt;
+    Part1Output tails{0};
+    for (const auto &[dr, dc] : directions) {
+        // The columns a word can start in without running off either side
+        const std::ptrdiff_t first = dc < 0 ? 3 : 0, last = cols - (dc > 0 ? 3 : 0);
+        for (std::ptrdiff_t r = 0; r + 3 * dr < rows; r++) {
+            auto c = first;
+            for (; c + w <= last; c += w) {
+                V x, m, a, s;
+                std::memcpy(&x, grid + r * cols + c, w);
+                std::memcpy(&m, grid + (r + dr) * cols + c + dc, w);
+                std::memcpy(&a, grid + (r + 2 * dr) * cols + c + 2 * dc, w);
+                std::memcpy(&s, grid + (r + 3 * dr) * cols + c + 3 * dc, w);
+                cnt.add(((x == 'X') & (m == 'M') & (a == 'A') & (s == 'S')) |
+                        ((x == 'S') & (m == 'A') & (a == 'M') & (s == 'X')));
+            }
+            for (; c < last; c++)
+                tails += xmas_at(grid, cols, r, c, dr, dc);
+        }
+    }
+    return cnt.flush() + tails;
+}
+
+template <class V>
+[[gnu::always_inline]] inline Part2Output count_x_mas_vector(const Input &word_search) {
+    constexpr std::ptrdiff_t w = sizeof(V);
+    const std::ptrdiff_t rows = word_search.rows(), cols = word_search.cols();
+    const auto *const grid = word_search.data();
+
+    lane_counts<V> cnt;
+    Part2Output tails{0};
+    for (std::ptrdiff_t r = 1; r + 1 < rows; r++) {
+        std::ptrdiff_t c = 1;
+        for (; c + w + 1 <= cols; c += w) {
+            V a, top_left, top_right, bottom_left, bottom_right;
+            std::memcpy(&a, grid + r * cols + c, w);
+            std::memcpy(&top_left, grid + (r - 1) * cols + c - 1, w);
+            std::memcpy(&top_right, grid + (r - 1) * cols + c + 1, w);
+            std::memcpy(&bottom_left, grid + (r + 1) * cols + c - 1, w);
+            std::memcpy(&bottom_right, grid + (r + 1) * cols + c + 1, w);
+            cnt.add((a == 'A') &
+                    (((top_left == 'M') & (bottom_right == 'S')) | ((top_left == 'S') & (bottom_right == 'M'))) &
+                    (((top_right == 'M') & (bottom_left == 'S')) | ((top_right == 'S') & (bottom_left == 'M'))));
+        }
+        for (; c + 1 < cols; c++)
+            tails += x_mas_at(grid, cols, r, c);
+    }
+    return cnt.flush() + tails;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) Part1Output count_xmas_sse2(const Input &word_search) {
+    return count_xmas_vector<v16>(word_search);
+}
+
+__attribute__((target("avx2"))) Part1Output count_xmas_avx2(const Input &word_search) {
+    return count_xmas_vector<v32>(word_search);
+}
+
+__attribute__((target("sse2"))) Part2Output count_x_mas_sse2(const Input &word_search) {
+    return count_x_mas_vector<v16>(word_search);
+}
+
+__attribute__((target("avx2"))) Part2Output count_x_mas_avx2(const Input &word_search) {
+    return count_x_mas_vector<v32>(word_search);
+}
+
+// AVX-512 compares straight into mask registers, which GCC doesn't make good use of from generic vectors, so this
+// level is written out with intrinsics instead, counting matches by popcount
+
+// Where the 64 cells from p are c
+__attribute__((target("avx512f,avx512bw"))) inline __mmask64 cells_are(const char *p, char c) {
+    return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), _mm512_set1_epi8(c));
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt"))) Part1Output count_xmas_avx512(const Input &word_search) {
+    constexpr int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    const std::ptrdiff_t rows = word_search.rows(), cols = word_search.cols();
+    const auto *const grid = word_search.data();
+
+    Part1Output cnt{0};
+    for (const auto &[dr, dc] : directions) {
+        const std::ptrdiff_t first = dc < 0 ? 3 : 0, last = cols - (dc > 0 ? 3 : 0);
+        for (std::ptrdiff_t r = 0; r + 3 * dr < rows; r++) {
+            auto c = first;
+            for (; c + 64 <= last; c += 64) {
+                const char *const cell[4] = {grid + r * cols + c, grid + (r + dr) * cols + c + dc,
+                                             grid + (r + 2 * dr) * cols + c + 2 * dc,
+                                             grid + (r + 3 * dr) * cols + c + 3 * dc};
+                const auto forwards = cells_are(cell[0], 'X') & cells_are(cell[1], 'M') & cells_are(cell[2], 'A') &
+                                      cells_are(cell[3], 'S'),
+                           backwards = cells_are(cell[0], 'S') & cells_are(cell[1], 'A') & cells_are(cell[2], 'M') &
+                                       cells_are(cell[3], 'X');
+                cnt += __builtin_popcountll(forwards | backwards);
+            }
+            for (; c < last; c++)
+                cnt += xmas_at(grid, cols, r, c, dr, dc);
+        }
+    }
+    return cnt;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt"))) Part2Output count_x_mas_avx512(const Input &word_search) {
+    const std::ptrdiff_t rows = word_search.rows(), cols = word_search.cols();
+    const auto *const grid = word_search.data();
+
+    Part2Output cnt{0};
+    for (std::ptrdiff_t r = 1; r + 1 < rows; r++) {
+        std::ptrdiff_t c = 1;
+        for (; c + 64 + 1 <= cols; c += 64) {
+            const auto *const above = grid + (r - 1) * cols + c, *const below = grid + (r + 1) * cols + c;
+            const auto falling = (cells_are(above - 1, 'M') & cells_are(below + 1, 'S')) |
+                                 (cells_are(above - 1, 'S') & cells_are(below + 1, 'M')),
+                       rising = (cells_are(above + 1, 'M') & cells_are(below - 1, 'S')) |
+                                (cells_are(above + 1, 'S') & cells_are(below - 1, 'M'));
+            cnt += __builtin_popcountll(cells_are(grid + r * cols + c, 'A') & falling & rising);
+        }
+        for (; c + 1 < cols; c++)
+            cnt += x_mas_at(grid, cols, r, c);
+    }
+    return cnt;
+}
+#endif
+
+const simd_kernel<Part1Output(const Input &)> count_xmas{
+    {simd_level::Scalar, count_xmas_scalar},
+#if defined(__x86_64__) || defined(__i386__)
+    {simd_level::SSE2, count_xmas_sse2},
+    {simd_level::AVX2, count_xmas_avx2},
+    {simd_level::AVX512, count_xmas_avx512},
+#endif
+};
+
+const simd_kernel<Part2Output(const Input &)> count_x_mas{
+    {simd_level::Scalar, count_x_mas_scalar},
+#if defined(__x86_64__) || defined(__i386__)
+    {simd_level::SSE2, count_x_mas_sse2},
+    {simd_level::AVX2, count_x_mas_avx2},
+    {simd_level::AVX512, count_x_mas_avx512},
+#endif
+};
+
+} // namespace
+
+Part1Output part1(const Input &word_search) {
+    return count_xmas(word_search);
+}
+
+Part2Output part2(const Input &word_search) {
+    return count_x_mas(word_search);
+}
+
 #ifdef TESTING
 TEST_CASE("day 4 sample", "[day4][sample]") {
     // clang-format off: want to keep this matrix-style formatting
@@ -134,7 +349,7 @@ TEST_CASE("day 4 sample", "[day4][sample]") {
     // clang-format on
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day4-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day4-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -153,7 +368,7 @@ TEST_CASE("day 4 sample", "[day4][sample]") {
 }
 
 TEST_CASE("day 4", "[day4]") {
-    std::ifstream input_fixture{"fixtures/day4-input.txt"};
+    const mapped_file input_fixture{"fixtures/day4-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -167,6 +382,70 @@ TEST_CASE("day 4", "[day4]") {
         const auto expected = 1873U, actual = part2(input);
         REQUIRE(expected == actual);
     }
+
+    SECTION("every variant the CPU can run agrees") {
+        for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+            const auto level = static_cast<simd_level>(i);
+            INFO("level " << simd_level_name(level));
+            CHECK(count_xmas.variant(level)(input) == 2524U);
+            CHECK(count_x_mas.variant(level)(input) == 1873U);
+        }
+    }
+}
+
+TEST_CASE("day 4 grids smaller and larger than a vector", "[day4]") {
+    // Words against every edge, and in a grid too narrow for the vector loops, so that it's all down to the tails
+    const std::vector<Input> grids{
+        Input{{'X', 'M', 'A', 'S'}, {'M', 'M', 'M', 'A'}, {'A', 'A', 'A', 'M'}, {'S', 'A', 'M', 'X'}},
+        Input{{'S'}, {'A'}, {'M'}, {'X'}},
+        Input{0, 0},
+    };
+    for (const auto &grid : grids) {
+        for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+            const auto level = static_cast<simd_level>(i);
+            INFO("level " << simd_level_name(level));
+            CHECK(count_xmas.variant(level)(grid) == count_xmas_scalar(grid));
+        }
+    }
+
+    // A grid wider than any vector, with words straddling where one vector's worth of columns ends and the next begins
+    Input wide{5, 150, '.'};
+    for (std::size_t c = 10; c + 15 < 150; c += 15) {
+        for (std::size_t k = 0; k < 4; k++) {
+            wide(0, c + k) = "XMAS"[k];
+            wide(1 + k, c - k) = "SAMX"[k];
+            wide(1 + k, c + 2 + k) = "XMAS"[k];
+        }
+        wide(2, c + 12) = wide(4, c + 12) = 'M';
+        wide(3, c + 13) = 'A';
+        wide(2, c + 14) = wide(4, c + 14) = 'S';
+    }
+    for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+        const auto level = static_cast<simd_level>(i);
+        INFO("level " << simd_level_name(level));
+        CHECK(count_xmas.variant(level)(wide) == count_xmas_scalar(wide));
+        CHECK(count_x_mas.variant(level)(wide) == count_x_mas_scalar(wide));
+    }
+}
+#endif
+
+#ifdef BENCHMARKING
+TEST_CASE("day 4", "[day4]") {
+    const mapped_file input_fixture{"fixtures/day4-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
 }
 #endif
 
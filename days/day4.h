@@ -1,5 +1,5 @@
 #include <cstdint>
-#include <fstream>
+#include <string_view>
 
 #include "matrix.h"
 
@@ -11,7 +11,7 @@ using Input = dynamic_matrix<char>;
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &word_search);
 Part2Output part2(const Input &word_search);
@@ -1,87 +1,65 @@
 #include <algorithm>
-#include <cassert>
 #include <deque>
-#include <sstream>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "day5.h"
+#include "line_index.h"
+#include "parallel.h"
+#include "scan.h"
+#include "trace.h"
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
 
-namespace Catch {
-std::string StringMaker<aoc::day5::Input>::convert(const aoc::day5::Input &value) {
-    std::ostringstream oss;
-
-    for (const auto it : value.rules) {
-        const auto k = it.first;
-        const auto vs = it.second;
-        for (const auto v : vs)
-            oss << k << '|' << v << '\n';
-    }
-
-    oss << '\n';
-
-    for (const auto &update : value.updates) {
-        for (auto it = std::cbegin(update); it != std::cend(update); it++) {
-            oss << *it;
-            if (it != std::cend(update) - 1)
-                oss << ',';
-        }
-        oss << '\n';
-    }
-
-    return oss.str();
-}
-} // namespace Catch
+#include "mapped_file.h"
 #endif
 
 namespace aoc::day5 {
 
-bool Input::operator==(const Input &other) const {
-    return rules == other.rules && updates == other.updates;
-}
-
-bool Input::operator!=(const Input &other) const {
-    return !(*this == other);
-}
-
-Input parse_input(std::ifstream &input) {
-    Input i;
-
-    // Parse rules
-    for (std::string rule; std::getline(input, rule) && !rule.empty();) {
-        std::uint32_t a, b;
-        const auto n = rule.find('|');
-        assert(n != std::string::npos);
-        a = std::stoul(rule.substr(0, n));
-        b = std::stoul(rule.substr(n + 1));
-        i.rules[a].insert(b);
-        i.rules.insert(std::make_pair(b, std::set<std::uint32_t>{}));
-    }
-
-    // Parse updates
-    for (std::string update_s; std::getline(input, update_s);) {
-        std::vector<std::uint32_t> update;
-        std::istringstream iss{update_s};
-        for (std::string value; std::getline(iss, value, ',');)
-            update.push_back(std::stoul(value));
+Input parse_input(std::string_view input) {
+    const line_index lines{input};
+    return parse_narrowest<Pages>([&lines](auto width) {
+        using Page = typename decltype(width)::type;
+        Pages<Page> i;
+        std::size_t n = 0;
+
+        // Parse rules
+        for (; n < lines.size() && !lines.line(n).empty(); n++) {
+            scanner s{lines.line(n)};
+            const auto a = s.number<Page>();
+            s.expect('|');
+            const auto b = s.number<Page>();
+            i.rules[a].insert(b);
+            i.rules.try_emplace(b);
+        }
 
-        i.updates.emplace_back(std::move(update));
-    }
+        // Parse updates, which start after the blank line. Every page takes at least two bytes, a digit and the comma
+        // or newline after it.
+        const auto first_update = std::min(n + 1, lines.size());
+        i.updates.reserve(lines.size() - first_update, lines.lines(first_update, lines.size()).size() / 2);
+        for (n = first_update; n < lines.size(); n++) {
+            scanner s{lines.line(n)};
+            for (Page page; s.next(page);)
+                i.updates.push_back(page);
+            i.updates.end_row();
+        }
 
-    return i;
+        return i;
+    });
 }
 
-static bool is_correct_order(const std::map<std::uint32_t, std::set<std::uint32_t>> &rules,
-                             const std::vector<std::uint32_t> &update) {
+template <class Page>
+static bool is_correct_order(const rule_map<Page> &rules, typename jagged_array<Page>::row update) {
     for (auto it = std::cbegin(update); it != std::cend(update) - 1; it++) {
         const auto e = *it, neighbor = it[1];
         if (std::find_if(std::cbegin(rules), std::cend(rules),
-                         [e](const auto kv) {
+                         [e](const auto &kv) {
                              return e == kv.first;
                          }) != std::cend(rules) &&
             std::find_if(std::cbegin(rules), std::cend(rules),
-                         [neighbor](const auto kv) {
+                         [neighbor](const auto &kv) {
                              return neighbor == kv.first;
                          }) != std::cend(rules) &&
             rules.at(e).find(neighbor) == std::cend(rules.at(e)))
@@ -91,8 +69,8 @@ static bool is_correct_order(const std::map<std::uint32_t, std::set<std::uint32_
     return true;
 }
 
-static void visit(std::set<std::uint32_t> &seen, std::vector<std::uint32_t> &reordered,
-                  const std::map<std::uint32_t, std::set<std::uint32_t>> &rules, std::uint32_t v) {
+template <class Page>
+static void visit(std::pmr::set<Page> &seen, std::vector<Page> &reordered, const rule_map<Page> &rules, Page v) {
     seen.insert(v);
     for (const auto u : rules.at(v))
         if (seen.find(u) == std::end(seen))
@@ -100,11 +78,12 @@ static void visit(std::set<std::uint32_t> &seen, std::vector<std::uint32_t> &reo
     reordered.push_back(v);
 }
 
-static std::vector<std::uint32_t> reorder(const std::map<std::uint32_t, std::set<std::uint32_t>> &rules,
-                                          const std::vector<std::uint32_t> &update) {
-    std::vector<std::uint32_t> reordered;
+template <class Page>
+static std::vector<Page> reorder(const rule_map<Page> &rules, typename jagged_array<Page>::row update) {
+    AOC_TRACE_SCOPE("reorder");
+    std::vector<Page> reordered;
     reordered.reserve(update.size());
-    std::set<std::uint32_t> seen;
+    std::pmr::set<Page> seen{current_arena()};
 
     // We DON'T want to visit any rules mentioning any numbers NOT in update.
     for (const auto &kv : rules)
@@ -121,36 +100,85 @@ static std::vector<std::uint32_t> reorder(const std::map<std::uint32_t, std::set
     return reordered;
 }
 
-Part1Output part1(const Input &input) {
-    Part1Output sum{0};
+// Sums the middle pages of updates [first, last): of the ones that are in the right order already, or of the others
+// once they have been put in order
+template <bool fix_order, class Page>
+static std::uint32_t sum_middle_pages(const Pages<Page> &pages, std::size_t first, std::size_t last) {
+    std::uint32_t sum{0};
 
-    for (const auto &update : input.updates) {
-        if (!is_correct_order(input.rules, update))
+    for (auto i = first; i < last; i++) {
+        const auto update = pages.updates[i];
+        if (is_correct_order(pages.rules, update) == fix_order)
             continue;
 
-        sum += update[update.size() / 2];
+        if (fix_order) {
+            const auto reordered = reorder(pages.rules, update);
+            sum += reordered[reordered.size() / 2];
+        } else {
+            sum += update[update.size() / 2];
+        }
     }
 
     return sum;
 }
 
-Part2Output part2(const Input &input) {
-    Part2Output sum{0};
+template <bool fix_order>
+static std::uint32_t reference_sum(const Input &input) {
+    return std::visit(
+        [](const auto &pages) {
+            return sum_middle_pages<fix_order>(pages, 0, pages.updates.size());
+        },
+        input);
+}
 
-    for (const auto &update : input.updates) {
-        if (is_correct_order(input.rules, update))
-            continue;
+// Updates are checked (and reordered) independently of each other, so they are shared out between threads
+template <bool fix_order>
+static std::uint32_t parallel_sum(const Input &input) {
+    return std::visit(
+        [](const auto &pages) {
+            return parallel_reduce(
+                0, pages.updates.size(), 0, std::uint32_t{0},
+                [&pages](std::uint32_t &sum, std::size_t first, std::size_t last) {
+                    sum += sum_middle_pages<fix_order>(pages, first, last);
+                },
+                [](std::uint32_t a, std::uint32_t b) {
+                    return a + b;
+                });
+        },
+        input);
+}
 
-        const auto reordered = reorder(input.rules, update);
-        sum += reordered[reordered.size() / 2];
-    }
+static std::size_t update_count(const Input &input) {
+    return std::visit(
+        [](const auto &pages) {
+            return pages.updates.size();
+        },
+        input);
+}
 
-    return sum;
+const engine_set<Input, Part1Output> part1_engines{
+    "day 5 part 1",
+    "updates",
+    update_count,
+    {{engine::Reference, reference_sum<false>}, {engine::Parallel, parallel_sum<false>, 100}}};
+
+const engine_set<Input, Part2Output> part2_engines{
+    "day 5 part 2",
+    "updates",
+    update_count,
+    {{engine::Reference, reference_sum<true>}, {engine::Parallel, parallel_sum<true>, 20}}};
+
+Part1Output part1(const Input &input) {
+    return part1_engines(input);
+}
+
+Part2Output part2(const Input &input) {
+    return part2_engines(input);
 }
 
 #ifdef TESTING
 TEST_CASE("day 5 sample", "[day5][sample]") {
-    Input input;
+    Pages<std::uint8_t> input;
     input.rules = {{47, {53, 13, 61, 29}},
                    {97, {13, 61, 47, 29, 53, 75}},
                    {75, {29, 53, 47, 61, 13}},
@@ -163,11 +191,12 @@ TEST_CASE("day 5 sample", "[day5][sample]") {
     const std::vector<std::uint32_t> correct_order{97, 75, 47, 61, 53, 29, 13};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day5-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day5-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
-        REQUIRE(input == parsed_input);
+        REQUIRE(std::holds_alternative<Pages<std::uint8_t>>(parsed_input));
+        REQUIRE(input == std::get<Pages<std::uint8_t>>(parsed_input));
     }
 
     SECTION("is_correct_order") {
@@ -181,24 +210,30 @@ TEST_CASE("day 5 sample", "[day5][sample]") {
     }
 
     SECTION("reorder") {
-        CHECK(reorder(input.rules, input.updates[3]) == std::vector<std::uint32_t>{97, 75, 47, 61, 53});
-        CHECK(reorder(input.rules, input.updates[4]) == std::vector<std::uint32_t>{61, 29, 13});
-        CHECK(reorder(input.rules, input.updates[5]) == std::vector<std::uint32_t>{97, 75, 47, 29, 13});
+        CHECK(reorder(input.rules, input.updates[3]) == std::vector<std::uint8_t>{97, 75, 47, 61, 53});
+        CHECK(reorder(input.rules, input.updates[4]) == std::vector<std::uint8_t>{61, 29, 13});
+        CHECK(reorder(input.rules, input.updates[5]) == std::vector<std::uint8_t>{97, 75, 47, 29, 13});
     }
 
     SECTION("part 1") {
-        const auto expected = 143U, actual = part1(input);
+        const auto expected = 143U, actual = part1(Input{std::move(input)});
         REQUIRE(expected == actual);
     }
 
     SECTION("part 2") {
-        const auto expected = 123U, actual = part2(input);
+        const auto expected = 123U, actual = part2(Input{std::move(input)});
         REQUIRE(expected == actual);
     }
+
+    SECTION("page numbers too big for a byte are stored wider") {
+        const auto parsed_input{parse_input("100|300\n\n100,300,7\n")};
+        REQUIRE(std::holds_alternative<Pages<std::uint16_t>>(parsed_input));
+        CHECK(part1(parsed_input) == 300U);
+    }
 }
 
 TEST_CASE("day 5", "[day5]") {
-    std::ifstream input_fixture{"fixtures/day5-input.txt"};
+    const mapped_file input_fixture{"fixtures/day5-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -212,6 +247,44 @@ TEST_CASE("day 5", "[day5]") {
         const auto expected = 4944U, actual = part2(input);
         REQUIRE(expected == actual);
     }
+
+    SECTION("every engine agrees") {
+        for (std::size_t i = 0; i < engine_count; i++) {
+            const auto e = static_cast<engine>(i);
+            INFO(engine_name(e) << " engine");
+            CHECK(part1_engines.variant(e)(input) == 6612U);
+            CHECK(part2_engines.variant(e)(input) == 4944U);
+        }
+    }
+}
+#endif
+
+#ifdef BENCHMARKING
+TEST_CASE("day 5", "[day5]") {
+    const mapped_file input_fixture{"fixtures/day5-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+
+    const auto &pages = std::get<Pages<std::uint8_t>>(input);
+    std::size_t unordered = 0;
+    while (is_correct_order(pages.rules, pages.updates[unordered]))
+        unordered++;
+
+    BENCHMARK("reorder") {
+        return reorder(pages.rules, pages.updates[unordered]);
+    };
 }
 #endif
 
@@ -1,39 +1,78 @@
 #include <cstdint>
-#include <fstream>
 #include <map>
 #include <set>
-#include <vector>
+#include <string_view>
+
+#include "arena.h"
+#include "engine.h"
+#include "jagged_array.h"
+#include "narrow.h"
 
 #pragma once
 
 namespace aoc::day5 {
-struct Input {
-    std::map<std::uint32_t, std::set<std::uint32_t>> rules;
-    std::vector<std::vector<std::uint32_t>> updates;
+// Which pages must come after each page
+template <class Page>
+using rule_map = std::pmr::map<Page, std::pmr::set<Page>>;
+
+template <class Page>
+struct Pages {
+    rule_map<Page> rules{current_arena()};
+    jagged_array<Page> updates;
 
-    Input() = default;
-    Input(Input &&input) = default;
+    bool operator==(const Pages &other) const {
+        return rules == other.rules && updates == other.updates;
+    }
 
-    bool operator==(const Input &other) const;
-    bool operator!=(const Input &other) const;
+    bool operator!=(const Pages &other) const {
+        return !(*this == other);
+    }
 };
 
+// Page numbers are stored in the narrowest type that fits them all
+using Input = narrow_variant<Pages>;
 using Part1Output = std::uint32_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &input);
 Part2Output part2(const Input &input);
+
+// The engines part1() and part2() choose between: going through the updates one at a time for reference, or sharing
+// them out over the shared pool
+extern const engine_set<Input, Part1Output> part1_engines;
+extern const engine_set<Input, Part2Output> part2_engines;
 } // namespace aoc::day5
 
 #ifdef TESTING
 #include <catch2/catch.hpp>
+#include <sstream>
 
 namespace Catch {
-template <>
-struct StringMaker<aoc::day5::Input> {
-    static std::string convert(const aoc::day5::Input &value);
+template <class Page>
+struct StringMaker<aoc::day5::Pages<Page>> {
+    static std::string convert(const aoc::day5::Pages<Page> &value) {
+        std::ostringstream oss;
+
+        // Unary + so that single-byte pages print as numbers rather than characters
+        for (const auto &[k, vs] : value.rules)
+            for (const auto v : vs)
+                oss << +k << '|' << +v << '\n';
+
+        oss << '\n';
+
+        for (const auto update : value.updates) {
+            for (auto it = std::cbegin(update); it != std::cend(update); it++) {
+                oss << +*it;
+                if (it != std::cend(update) - 1)
+                    oss << ',';
+            }
+            oss << '\n';
+        }
+
+        return oss.str();
+    }
 };
 } // namespace Catch
 #endif
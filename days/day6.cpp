@@ -1,10 +1,17 @@
 #include <algorithm>
+#include <memory_resource>
 #include <set>
+#include <tuple>
 
+#include "arena.h"
 #include "day6.h"
+#include "split.h"
+#include "trace.h"
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 #define loop for (;;)
@@ -18,37 +25,30 @@ enum class Direction {
     West
 };
 
-using seen_set = std::set<std::tuple<Input::container_type::size_type, Input::container_type::size_type, Direction>>;
-
-Input parse_input(std::ifstream &input) {
-    std::pair<Input::container_type::size_type, Input::container_type::size_type> start;
-    Input::container_type::size_type rows{1}, cols{0}, c{0};
-    std::ifstream::int_type chr;
-    // Count number of columns
-    for (; (chr = input.get()) != '\n'; cols++)
-        if (chr == '^')
-            start = std::make_pair(0, cols);
-    // Count number of rows
-    while (input) {
-        switch ((chr = input.get())) {
-        case '\n':
-            rows++;
-            c = 0;
-            break;
-        case '^': start = std::make_pair(rows, c);
-        default: c++;
+using seen_set =
+    std::pmr::set<std::tuple<bit_matrix::size_type, bit_matrix::size_type, Direction>>;
+
+Input parse_input(std::string_view input) {
+    // The number of columns is the length of the first line and the number of rows is the number of lines
+    const bit_matrix::size_type cols = std::min(input.find('\n'), input.size()),
+                                rows = std::count(std::cbegin(input), std::cend(input), '\n') +
+                                       (!input.empty() && input.back() != '\n');
+    Input i{bit_matrix{rows, cols}, {}};
+    for (bit_matrix::size_type r = 0; r < rows; r++) {
+        const auto line = next_token(input, '\n');
+        for (bit_matrix::size_type c = 0; c < std::min(line.size(), cols); c++) {
+            if (line[c] == '#')
+                i.walls.set(r, c);
+            else if (line[c] == '^')
+                i.start = std::make_pair(r, c);
         }
     }
-    // Now that we've determined the matrix dimensions, go back to the start and read in the matrix
-    input.clear(); // https://stackoverflow.com/a/28331018
-    input.seekg(0);
-    Input::container_type m{rows, cols, '.'};
-    input >> m;
-    return Input{std::move(m), start};
+
+    return i;
 }
 
-Part1Output part1(const Input &input) {
-    std::set<std::pair<Input::container_type::size_type, Input::container_type::size_type>> seen;
+static Part1Output reference_visited(const Input &input) {
+    std::pmr::set<std::pair<bit_matrix::size_type, bit_matrix::size_type>> seen{current_arena()};
     auto cur = input.start;
     auto direction = Direction::North;
 
@@ -56,32 +56,32 @@ Part1Output part1(const Input &input) {
         seen.insert(cur);
         // Are we about to leave the maze?
         if ((direction == Direction::North && cur.first == 0) ||
-            (direction == Direction::East && cur.second == input.maze.cols() - 1) ||
-            (direction == Direction::South && cur.first == input.maze.rows() - 1) ||
+            (direction == Direction::East && cur.second == input.walls.cols() - 1) ||
+            (direction == Direction::South && cur.first == input.walls.rows() - 1) ||
             (direction == Direction::West && cur.second == 0))
             break;
 
         switch (direction) {
         case Direction::North:
-            if (input.maze(cur.first - 1, cur.second) == '#')
+            if (input.walls(cur.first - 1, cur.second))
                 direction = Direction::East;
             else
                 cur.first--;
             break;
         case Direction::East:
-            if (input.maze(cur.first, cur.second + 1) == '#')
+            if (input.walls(cur.first, cur.second + 1))
                 direction = Direction::South;
             else
                 cur.second++;
             break;
         case Direction::South:
-            if (input.maze(cur.first + 1, cur.second) == '#')
+            if (input.walls(cur.first + 1, cur.second))
                 direction = Direction::West;
             else
                 cur.first++;
             break;
         case Direction::West:
-            if (input.maze(cur.first, cur.second - 1) == '#')
+            if (input.walls(cur.first, cur.second - 1))
                 direction = Direction::North;
             else
                 cur.second--;
@@ -92,41 +92,88 @@ Part1Output part1(const Input &input) {
     return seen.size();
 }
 
-static bool simulate(const seen_set &seen, const Input::container_type &maze,
-                     std::pair<Input::container_type::size_type, Input::container_type::size_type> cur,
-                     Direction direction) {
-    seen_set simulated_seen{seen};
+// The same walk, but the cells the guard has been to are marked in a bit_matrix the size of the map rather than kept in
+// a set, and each step is a table lookup rather than a switch
+static Part1Output serial_visited(const Input &input) {
+    using size_type = bit_matrix::size_type;
+    // Steps north, east, south and west; going off the top or left edge wraps round to a huge row or column
+    constexpr size_type row_step[] = {static_cast<size_type>(-1), 0, 1, 0};
+    constexpr size_type col_step[] = {0, 1, 0, static_cast<size_type>(-1)};
+    const auto &walls = input.walls;
+    auto [row, col] = input.start;
+    if (row >= walls.rows() || col >= walls.cols())
+        return 1; // Only the guard's own cell, as reference_visited() counts it
+
+    bit_matrix visited{walls.rows(), walls.cols()};
+    Part1Output n{0};
+    std::size_t direction = 0;
+    loop {
+        if (!visited(row, col)) {
+            visited.set(row, col);
+            n++;
+        }
+        const auto next_row = row + row_step[direction], next_col = col + col_step[direction];
+        if (next_row >= walls.rows() || next_col >= walls.cols())
+            break;
+        if (walls(next_row, next_col)) {
+            direction = (direction + 1) % 4;
+        } else {
+            row = next_row;
+            col = next_col;
+        }
+    }
+
+    return n;
+}
+
+static std::size_t cells(const Input &input) {
+    return input.walls.rows() * input.walls.cols();
+}
+
+const engine_set<Input, Part1Output> part1_engines{
+    "day 6 part 1", "cells", cells, {{engine::Reference, reference_visited}, {engine::Serial, serial_visited}}};
+
+Part1Output part1(const Input &input) {
+    return part1_engines(input);
+}
+
+// Nodes of the copy of seen come from scratch, which should recycle them between calls
+static bool simulate(const seen_set &seen, const bit_matrix &walls,
+                     std::pair<bit_matrix::size_type, bit_matrix::size_type> cur,
+                     Direction direction, std::pmr::memory_resource *scratch) {
+    AOC_TRACE_SCOPE("simulate");
+    seen_set simulated_seen{seen, scratch};
     loop {
         if (!simulated_seen.insert(std::make_tuple(cur.first, cur.second, direction)).second)
             return true;
         // Are we about to leave the maze?
         if ((direction == Direction::North && cur.first == 0) ||
-            (direction == Direction::East && cur.second == maze.cols() - 1) ||
-            (direction == Direction::South && cur.first == maze.rows() - 1) ||
+            (direction == Direction::East && cur.second == walls.cols() - 1) ||
+            (direction == Direction::South && cur.first == walls.rows() - 1) ||
             (direction == Direction::West && cur.second == 0))
             break;
 
         switch (direction) {
         case Direction::North:
-            if (maze(cur.first - 1, cur.second) == '#')
+            if (walls(cur.first - 1, cur.second))
                 direction = Direction::East;
             else
                 cur.first--;
             break;
         case Direction::East:
-            if (maze(cur.first, cur.second + 1) == '#')
+            if (walls(cur.first, cur.second + 1))
                 direction = Direction::South;
             else
                 cur.second++;
             break;
         case Direction::South:
-            if (maze(cur.first + 1, cur.second) == '#')
+            if (walls(cur.first + 1, cur.second))
                 direction = Direction::West;
             else
                 cur.first++;
             break;
         case Direction::West:
-            if (maze(cur.first, cur.second - 1) == '#')
+            if (walls(cur.first, cur.second - 1))
                 direction = Direction::North;
             else
                 cur.second--;
@@ -138,7 +185,9 @@ static bool simulate(const seen_set &seen, const Input::container_type &maze,
 }
 
 Part2Output part2(const Input &input) {
-    seen_set seen;
+    seen_set seen{current_arena()};
+    // Every simulation copies seen and throws the copy away again, so keep its nodes in a pool to be reused
+    std::pmr::unsynchronized_pool_resource scratch{current_arena()};
     auto cur = input.start;
     auto direction = Direction::North;
     Part2Output cnt{0};
@@ -147,19 +196,19 @@ Part2Output part2(const Input &input) {
         seen.insert(std::make_tuple(cur.first, cur.second, direction));
         // Are we about to leave the maze?
         if ((direction == Direction::North && cur.first == 0) ||
-            (direction == Direction::East && cur.second == input.maze.cols() - 1) ||
-            (direction == Direction::South && cur.first == input.maze.rows() - 1) ||
+            (direction == Direction::East && cur.second == input.walls.cols() - 1) ||
+            (direction == Direction::South && cur.first == input.walls.rows() - 1) ||
             (direction == Direction::West && cur.second == 0))
             break;
 
         switch (direction) {
         case Direction::North:
-            if (input.maze(cur.first - 1, cur.second) == '#') {
+            if (input.walls(cur.first - 1, cur.second)) {
                 direction = Direction::East;
             } else {
-                for (auto c = cur.second; c < input.maze.cols(); c++) {
-                    if (input.maze(cur.first, c) == '#') {
-                        if (simulate(seen, input.maze, cur, Direction::East))
+                for (auto c = cur.second; c < input.walls.cols(); c++) {
+                    if (input.walls(cur.first, c)) {
+                        if (simulate(seen, input.walls, cur, Direction::East, &scratch))
                             cnt++;
                         break;
                     }
@@ -168,12 +217,12 @@ Part2Output part2(const Input &input) {
             }
             break;
         case Direction::East:
-            if (input.maze(cur.first, cur.second + 1) == '#') {
+            if (input.walls(cur.first, cur.second + 1)) {
                 direction = Direction::South;
             } else {
-                for (auto r = cur.first; r < input.maze.rows(); r++) {
-                    if (input.maze(r, cur.second) == '#') {
-                        if (simulate(seen, input.maze, cur, Direction::South))
+                for (auto r = cur.first; r < input.walls.rows(); r++) {
+                    if (input.walls(r, cur.second)) {
+                        if (simulate(seen, input.walls, cur, Direction::South, &scratch))
                             cnt++;
                         break;
                     }
@@ -182,12 +231,12 @@ Part2Output part2(const Input &input) {
             }
             break;
         case Direction::South:
-            if (input.maze(cur.first + 1, cur.second) == '#') {
+            if (input.walls(cur.first + 1, cur.second)) {
                 direction = Direction::West;
             } else {
                 for (auto c = cur.second; c <= cur.second; c--) {
-                    if (input.maze(cur.first, c) == '#') {
-                        if (simulate(seen, input.maze, cur, Direction::West))
+                    if (input.walls(cur.first, c)) {
+                        if (simulate(seen, input.walls, cur, Direction::West, &scratch))
                             cnt++;
                         break;
                     }
@@ -196,12 +245,12 @@ Part2Output part2(const Input &input) {
             }
             break;
         case Direction::West:
-            if (input.maze(cur.first, cur.second - 1) == '#') {
+            if (input.walls(cur.first, cur.second - 1)) {
                 direction = Direction::North;
             } else {
                 for (auto r = cur.first; r <= cur.first; r--) {
-                    if (input.maze(r, cur.second) == '#') {
-                        if (simulate(seen, input.maze, cur, Direction::North))
+                    if (input.walls(r, cur.second)) {
+                        if (simulate(seen, input.walls, cur, Direction::North, &scratch))
                             cnt++;
                         break;
                     }
@@ -217,34 +266,32 @@ Part2Output part2(const Input &input) {
 
 #ifdef TESTING
 TEST_CASE("day 6 sample", "[day6][sample]") {
-    // clang-format off: want to keep this matrix-syle formatting
-    Input input{
-        {{'.', '.', '.', '.', '#', '.', '.', '.', '.', '.'},
-         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '#'},
-         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-         {'.', '.', '#', '.', '.', '.', '.', '.', '.', '.'},
-         {'.', '.', '.', '.', '.', '.', '.', '#', '.', '.'},
-         {'.', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-         {'.', '#', '.', '.', '^', '.', '.', '.', '.', '.'},
-         {'.', '.', '.', '.', '.', '.', '.', '.', '#', '.'},
-         {'#', '.', '.', '.', '.', '.', '.', '.', '.', '.'},
-         {'.', '.', '.', '.', '.', '.', '#', '.', '.', '.'}},
-        std::make_pair(6, 4)
-    };
-    // clang-format on
+    const Input input{bit_matrix{{"....#.....",
+                                  ".........#",
+                                  "..........",
+                                  "..#.......",
+                                  ".......#..",
+                                  "..........",
+                                  ".#..^.....",
+                                  "........#.",
+                                  "#.........",
+                                  "......#..."},
+                                 '#'},
+                      std::make_pair(6, 4)};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day6-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day6-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
-        CHECK(input.maze == parsed_input.maze);
+        CHECK(input.walls == parsed_input.walls);
         CHECK(input.start == parsed_input.start);
     }
 
     SECTION("part 1") {
         const Part1Output expected = 41, actual = part1(input);
         REQUIRE(expected == actual);
+        CHECK(part1_engines.variant(engine::Reference)(input) == expected);
     }
 
     SECTION("part 2") {
@@ -254,7 +301,7 @@ TEST_CASE("day 6 sample", "[day6][sample]") {
 }
 
 TEST_CASE("day 6", "[day6]") {
-    std::ifstream input_fixture{"fixtures/day6-input.txt"};
+    const mapped_file input_fixture{"fixtures/day6-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -264,10 +311,45 @@ TEST_CASE("day 6", "[day6]") {
         REQUIRE(expected == actual);
     }
 
+    SECTION("every engine agrees") {
+        for (std::size_t i = 0; i < engine_count; i++) {
+            const auto e = static_cast<engine>(i);
+            INFO(engine_name(e) << " engine");
+            CHECK(part1_engines.variant(e)(input) == 4647U);
+        }
+    }
+
     SECTION("part 2") {
         // TODO GET THIS TO PASS
         REQUIRE(part2(input) < 1826);
     }
 }
 #endif
+
+#ifdef BENCHMARKING
+TEST_CASE("day 6", "[day6]") {
+    const mapped_file input_fixture{"fixtures/day6-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+
+    // The guard's whole walk from the start, as part2() simulates it from each place it could be turned
+    const seen_set seen;
+    std::pmr::unsynchronized_pool_resource scratch;
+    BENCHMARK("simulate") {
+        return simulate(seen, input.walls, input.start, Direction::North, &scratch);
+    };
+}
+#endif
 } // namespace aoc::day6
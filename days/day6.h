@@ -1,25 +1,31 @@
 #include <cstdint>
-#include <fstream>
+#include <string_view>
 #include <utility>
 
-#include "matrix.h"
+#include "bit_matrix.h"
+#include "engine.h"
 
 #pragma once
 
 namespace aoc::day6 {
 
+// Where the obstructions are, one bit per cell, and where the guard starts
 struct Input {
-    using container_type = dynamic_matrix<char>;
-    container_type maze;
-    std::pair<container_type::size_type, container_type::size_type> start;
+    bit_matrix walls;
+    std::pair<bit_matrix::size_type, bit_matrix::size_type> start;
 };
 
 using Part1Output = std::size_t;
 using Part2Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &input);
 Part2Output part2(const Input &input);
 
+// The engines part1() chooses between: keeping the cells the guard has been to in a set for reference, or marking
+// them in a bit_matrix. Part 2 has only the one implementation so far; its answer isn't right yet (see its test), so
+// there is nothing for a faster one to be checked against.
+extern const engine_set<Input, Part1Output> part1_engines;
+
 } // namespace aoc::day6
@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <queue>
 
 #include "day7.h"
+#include "line_index.h"
+#include "parallel.h"
+#include "scan.h"
+#include "trace.h"
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 namespace aoc::day7 {
@@ -25,11 +34,13 @@ bool Equation::operator!=(const Equation &eqn) const {
     return !(*this == eqn);
 }
 
-bool Equation::can_be_true(bool use_concatenation) const {
+bool Equation::can_be_true(bool use_concatenation, std::pmr::memory_resource *scratch) const {
+    AOC_TRACE_SCOPE_ARG("can_be_true", "operands", operands.size());
     if (operands.empty())
         return false;
 
-    std::queue<std::pair<std::size_t, std::uint64_t>> to_visit;
+    using state = std::pair<std::size_t, std::uint64_t>;
+    std::queue<state, std::pmr::deque<state>> to_visit{std::pmr::deque<state>{scratch}};
     to_visit.push(std::make_pair(0, operands.front()));
     while (!to_visit.empty()) {
         const auto [i, e] = to_visit.front();
@@ -47,49 +58,135 @@ bool Equation::can_be_true(bool use_concatenation) const {
     return false;
 }
 
-Input parse_input(std::ifstream &input) {
-    Input equations;
+Input::Input(std::initializer_list<Equation> eqns) {
+    answers.reserve(eqns.size());
+    for (const auto &eqn : eqns) {
+        answers.push_back(eqn.answer);
+        operands.push_row(std::begin(eqn.operands), std::end(eqn.operands));
+    }
+}
 
-    for (std::string line; std::getline(input, line);) {
-        Equation eqn;
-        const auto colon = line.find(':');
-        eqn.answer = std::stoull(line.substr(0, colon));
-
-        for (auto i = colon + 2;;) {
-            const auto space = line.find(' ', i);
-            if (space == std::string::npos) {
-                eqn.operands.push_back(std::stoull(line.substr(i)));
-                break;
-            } else {
-                eqn.operands.push_back(std::stoull(line.substr(i, space - i)));
-                i = space + 1;
-            }
-        }
+bool Input::operator==(const Input &other) const {
+    return answers == other.answers && operands == other.operands;
+}
 
-        equations.emplace_back(std::move(eqn));
+bool Input::operator!=(const Input &other) const {
+    return !(*this == other);
+}
+
+Input parse_input(std::string_view input) {
+    const line_index lines{input};
+    Input equations;
+    // Every operand follows a space
+    equations.answers.reserve(lines.size());
+    equations.operands.reserve(lines.size(), std::count(std::begin(input), std::end(input), ' '));
+
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        scanner s{lines.line(i)};
+        equations.answers.push_back(s.number<std::uint64_t>());
+        s.expect(':');
+        for (std::uint64_t operand; s.next(operand);)
+            equations.operands.push_back(operand);
+        equations.operands.end_row();
     }
 
     return equations;
 }
 
-Part1Output part1(const Input &input) {
-    Part1Output total_calibration_result{0};
+// Whether the first n operands can be combined into target, working backwards from it: the last operand has to have
+// been added to, multiplied by or (with concatenation) appended to whatever the ones before it came to, and each of
+// those can only be undone if target is at least the operand, a multiple of it or ends in its digits respectively. That
+// rules out most branches straight away, where can_be_true() has to follow every one of them to the end.
+static bool can_make(std::uint64_t target, const std::uint64_t *operands, std::size_t n, bool use_concatenation) {
+    if (n == 0)
+        return false;
+    const auto last = operands[n - 1];
+    if (n == 1)
+        return target == last;
+    if (last == 0) // x * 0 is 0 whatever x is, and x + 0 and x || 0 are both x (see concat_digits())
+        return target == 0 || can_make(target, operands, n - 1, use_concatenation);
+
+    if (target % last == 0 && can_make(target / last, operands, n - 1, use_concatenation))
+        return true;
+    if (target >= last && can_make(target - last, operands, n - 1, use_concatenation))
+        return true;
+    if (use_concatenation) {
+        std::uint64_t p = 10;
+        while (p <= last && p <= std::numeric_limits<std::uint64_t>::max() / 10)
+            p *= 10;
+        if (p > last && target % p == last && can_make(target / p, operands, n - 1, use_concatenation))
+            return true;
+    }
+    return false;
+}
 
-    for (const auto &eqn : input)
-        if (eqn.can_be_true())
-            total_calibration_result += eqn.answer;
+static bool can_make(const Equation &eqn, bool use_concatenation) {
+    return can_make(eqn.answer, eqn.operands.data(), eqn.operands.size(), use_concatenation);
+}
 
-    return total_calibration_result;
+template <bool use_concatenation>
+static std::uint64_t reference_total(const Input &input) {
+    std::uint64_t total{0};
+    // Each search's queue blocks go back in the pool for the next one to reuse
+    std::pmr::unsynchronized_pool_resource scratch{current_arena()};
+
+    for (std::size_t i = 0; i < input.size(); i++)
+        if (const auto eqn = input[i]; eqn.can_be_true(use_concatenation, &scratch))
+            total += eqn.answer;
+
+    return total;
 }
 
-Part2Output part2(const Input &input) {
-    Part2Output total_calibration_result{0};
+template <bool use_concatenation>
+static std::uint64_t serial_total(const Input &input) {
+    std::uint64_t total{0};
 
-    for (const auto &eqn : input)
-        if (eqn.can_be_true(true))
-            total_calibration_result += eqn.answer;
+    for (std::size_t i = 0; i < input.size(); i++)
+        if (const auto eqn = input[i]; can_make(eqn, use_concatenation))
+            total += eqn.answer;
 
-    return total_calibration_result;
+    return total;
+}
+
+// Equations are searched independently of each other, so they are shared out between threads a chunk at a time
+template <bool use_concatenation>
+static std::uint64_t parallel_total(const Input &input) {
+    return parallel_reduce(
+        0, input.size(), 0, std::uint64_t{0},
+        [&input](std::uint64_t &total, std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; i++)
+                if (const auto eqn = input[i]; can_make(eqn, use_concatenation))
+                    total += eqn.answer;
+        },
+        [](std::uint64_t a, std::uint64_t b) {
+            return a + b;
+        });
+}
+
+static std::size_t equations(const Input &input) {
+    return input.size();
+}
+
+const engine_set<Input, Part1Output> part1_engines{"day 7 part 1",
+                                                   "equations",
+                                                   equations,
+                                                   {{engine::Reference, reference_total<false>},
+                                                    {engine::Serial, serial_total<false>},
+                                                    {engine::Parallel, parallel_total<false>, 1000}}};
+
+const engine_set<Input, Part2Output> part2_engines{"day 7 part 2",
+                                                   "equations",
+                                                   equations,
+                                                   {{engine::Reference, reference_total<true>},
+                                                    {engine::Serial, serial_total<true>},
+                                                    {engine::Parallel, parallel_total<true>, 500}}};
+
+Part1Output part1(const Input &input) {
+    return part1_engines(input);
+}
+
+Part2Output part2(const Input &input) {
+    return part2_engines(input);
 }
 
 #ifdef TESTING
@@ -99,7 +196,7 @@ TEST_CASE("day 7 sample", "[day7][sample]") {
                 {192, {17, 8, 14}}, {21037, {9, 7, 18, 13}}, {292, {11, 6, 16, 20}}};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day7-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day7-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -124,6 +221,21 @@ TEST_CASE("day 7 sample", "[day7][sample]") {
         CHECK(!Equation{1568, {49, 16, 2, 64, 852}}.can_be_true());
     }
 
+    SECTION("can_make agrees with can_be_true") {
+        for (std::size_t i = 0; i < input.size(); i++) {
+            INFO("equation " << i);
+            CHECK(can_make(input[i], false) == input[i].can_be_true(false));
+            CHECK(can_make(input[i], true) == input[i].can_be_true(true));
+        }
+        // Operands of 0, which can be concatenated or added without changing anything, or multiplied by to get 0
+        for (const auto &eqn : {Equation{0, {5, 0}}, Equation{5, {5, 0}}, Equation{50, {5, 0}}, Equation{7, {0, 7}},
+                                Equation{0, {3, 4, 0}}, Equation{12, {1, 0, 2}}, Equation{102, {1, 0, 2}}}) {
+            INFO(eqn.answer);
+            CHECK(can_make(eqn, false) == eqn.can_be_true(false));
+            CHECK(can_make(eqn, true) == eqn.can_be_true(true));
+        }
+    }
+
     SECTION("concat_digits") {
         CHECK(concat_digits(12LU, 34LU) == 1234LU);
     }
@@ -140,7 +252,7 @@ TEST_CASE("day 7 sample", "[day7][sample]") {
 }
 
 TEST_CASE("day 7", "[day7]") {
-    std::ifstream input_fixture{"fixtures/day7-input.txt"};
+    const mapped_file input_fixture{"fixtures/day7-input.txt"};
     REQUIRE(input_fixture);
 
     auto input = parse_input(input_fixture);
@@ -154,6 +266,53 @@ TEST_CASE("day 7", "[day7]") {
         const auto expected = 275791737999003LU, actual = part2(input);
         REQUIRE(expected == actual);
     }
+
+    SECTION("every engine agrees") {
+        for (std::size_t i = 0; i < engine_count; i++) {
+            const auto e = static_cast<engine>(i);
+            INFO(engine_name(e) << " engine");
+            CHECK(part1_engines.variant(e)(input) == 1399219271639LU);
+            CHECK(part2_engines.variant(e)(input) == 275791737999003LU);
+        }
+    }
+}
+#endif
+
+#ifdef BENCHMARKING
+TEST_CASE("day 7", "[day7]") {
+    const mapped_file input_fixture{"fixtures/day7-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+
+    BENCHMARK("part2") {
+        return part2(input);
+    };
+
+    BENCHMARK("concat_digits") {
+        return concat_digits(input.answers[0], input.operands[0][0]);
+    };
+
+    // The equation with the most operands, which is the most work to search
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i < input.size(); i++)
+        if (input.operands[i].size() > input.operands[longest].size())
+            longest = i;
+
+    BENCHMARK("can_be_true") {
+        return input[longest].can_be_true(false);
+    };
+
+    BENCHMARK("can_be_true with concatenation") {
+        return input[longest].can_be_true(true);
+    };
 }
 #endif
 
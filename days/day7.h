@@ -1,28 +1,60 @@
 #include <cstdint>
-#include <fstream>
+#include <initializer_list>
+#include <memory_resource>
+#include <string_view>
 #include <vector>
 
+#include "arena.h"
+#include "engine.h"
+#include "jagged_array.h"
+
 #pragma once
 
 namespace aoc::day7 {
 
 struct Equation {
     std::uint64_t answer;
-    std::vector<std::uint64_t> operands;
+    jagged_array<std::uint64_t>::row operands;
 
     bool operator==(const Equation &eqn) const;
     bool operator!=(const Equation &eqn) const;
 
-    bool can_be_true(bool use_concatenation = false) const;
+    // The search's queue is allocated from scratch, which should be a pool if this is called for many equations
+    bool can_be_true(bool use_concatenation = false, std::pmr::memory_resource *scratch = current_arena()) const;
+};
+
+// Every equation's answer, and its operands in the matching row of a jagged_array, rather than a vector of Equations
+// with a vector of operands each
+struct Input {
+    std::vector<std::uint64_t> answers;
+    jagged_array<std::uint64_t> operands;
+
+    Input() = default;
+    Input(std::initializer_list<Equation> eqns);
+
+    std::size_t size() const {
+        return answers.size();
+    }
+
+    Equation operator[](std::size_t i) const {
+        return Equation{answers[i], operands[i]};
+    }
+
+    bool operator==(const Input &other) const;
+    bool operator!=(const Input &other) const;
 };
 
-using Input = std::vector<Equation>;
 using Part1Output = std::uint64_t;
 using Part2Output = std::uint64_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &input);
 Part2Output part2(const Input &input);
 
+// The engines part1() and part2() choose between: can_be_true()'s search forwards from the first operand for reference,
+// and a search backwards from the answer that gives up on most branches at once, on one thread or on the shared pool
+extern const engine_set<Input, Part1Output> part1_engines;
+extern const engine_set<Input, Part2Output> part2_engines;
+
 } // namespace aoc::day7
@@ -1,18 +1,21 @@
+#include <stdexcept>
 #include <vector>
 
 #include "day8.h"
 
-#ifdef TESTING
+#if defined(TESTING) || defined(BENCHMARKING)
 #include <catch2/catch.hpp>
+
+#include "mapped_file.h"
 #endif
 
 namespace aoc::day8 {
 
-Input parse_input(std::ifstream &input) {
+Input parse_input(std::string_view input) {
     Input i;
 
     std::uint8_t r = 0, c = 0;
-    for (std::ifstream::char_type ch; input.get(ch);) {
+    for (const auto ch : input) {
         if (ch == '\n') {
             r++;
             if (!i.width)
@@ -63,7 +66,7 @@ TEST_CASE("day 8 sample", "[day8][sample]") {
                       {'A', {5, 6}}, {'A', {8, 8}}, {'A', {9, 9}}};
 
     SECTION("parse_input") {
-        std::ifstream input_fixture{"fixtures/day8-sample-input.txt"};
+        const mapped_file input_fixture{"fixtures/day8-sample-input.txt"};
         REQUIRE(input_fixture);
 
         const auto parsed_input{parse_input(input_fixture)};
@@ -86,4 +89,20 @@ TEST_CASE("day 8 sample", "[day8][sample]") {
 }
 #endif
 
+#ifdef BENCHMARKING
+TEST_CASE("day 8", "[day8]") {
+    const mapped_file input_fixture{"fixtures/day8-input.txt"};
+    REQUIRE(input_fixture);
+    const auto input = parse_input(input_fixture);
+
+    BENCHMARK("parse_input") {
+        return parse_input(input_fixture);
+    };
+
+    BENCHMARK("part1") {
+        return part1(input);
+    };
+}
+#endif
+
 } // namespace aoc::day8
@@ -1,7 +1,9 @@
 #include <array>
 #include <cstdint>
-#include <fstream>
 #include <map>
+#include <string_view>
+
+#include "arena.h"
 
 #pragma once
 
@@ -10,12 +12,12 @@ using Coord = std::array<std::uint8_t, 2>;
 
 struct Input {
     std::uint8_t height = 0, width = 0;
-    std::multimap<char, Coord> antennae;
+    std::pmr::multimap<char, Coord> antennae{current_arena()};
 };
 
 using Part1Output = std::uint32_t;
 
-Input parse_input(std::ifstream &input);
+Input parse_input(std::string_view input);
 
 Part1Output part1(const Input &input);
 
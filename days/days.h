@@ -0,0 +1,284 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "day0.h"
+#include "day1.h"
+#include "day2.h"
+#include "day3.h"
+#include "day4.h"
+#include "day5.h"
+#include "day6.h"
+#include "day7.h"
+#include "day8.h"
+#include "footprint.h"
+#include "serialize.h"
+
+#pragma once
+
+namespace aoc {
+
+template <auto Part, class Input>
+struct part_output {
+    using type = std::invoke_result_t<decltype(Part), Input &>;
+};
+
+template <class Input>
+struct part_output<nullptr, Input> {
+    using type = void;
+};
+
+// Everything the driver needs to know about one day, worked out at compile time from the day's own functions. Pass
+// nullptr for Part2 if the second half of the puzzle isn't done yet. Weight is a rough guess at how expensive the day
+// is relative to the others; when running several days at once the heaviest ones are started first.
+template <long N, auto Parse, auto Part1, auto Part2, unsigned Weight = 1>
+struct day {
+    static constexpr long number = N;
+    static constexpr unsigned weight = Weight;
+    static constexpr bool has_part2 = !std::is_null_pointer_v<decltype(Part2)>;
+
+    using input_type = std::invoke_result_t<decltype(Parse), std::string_view>;
+    using part1_output = typename part_output<Part1, input_type>::type;
+    using part2_output = typename part_output<Part2, input_type>::type;
+
+    static input_type parse(std::string_view input) {
+        return Parse(input);
+    }
+
+    static part1_output part1(input_type &input) {
+        return Part1(input);
+    }
+
+    static part2_output part2(input_type &input) {
+        if constexpr (has_part2)
+            return Part2(input);
+    }
+};
+
+// Every day that has been done so far, in order. Days 5, 6 and 7 are weighted by how long they take on the real
+// puzzle inputs in fixtures/.
+using registry = std::tuple<day<0, day0::parse_input, day0::part1, day0::part2>,
+                            day<1, day1::parse_input, day1::part1, day1::part2>,
+                            day<2, day2::parse_input, day2::part1, day2::part2>,
+                            day<3, day3::parse_input, day3::part1, day3::part2>,
+                            day<4, day4::parse_input, day4::part1, day4::part2>,
+                            day<5, day5::parse_input, day5::part1, day5::part2, 10>,
+                            day<6, day6::parse_input, day6::part1, day6::part2, 100>,
+                            day<7, day7::parse_input, day7::part1, day7::part2, 30>,
+                            day<8, day8::parse_input, day8::part1, nullptr>>;
+
+// Days whose answers can be worked out a run of whole lines at a time, with the answers for each run combined by merge1
+// and merge2, which must be associative and commutative since runs may finish in any order. Only these days can stream
+// their input from stdin, or when watched re-solve just the lines that changed; the rest need all of it at once (e.g.
+// day 1, which sorts its lists, or day 3, whose do() and don't() carry over from one line to the next). cut(text)
+// says how much of a stretch of input read so far can be solved on its own, or 0 if none of it can yet.
+template <long N>
+struct line_streaming {
+    static constexpr bool supported = false;
+};
+
+// Cuts streamed input after its last line break
+struct cut_at_lines {
+    static std::size_t cut(std::string_view text) {
+        const auto i = text.rfind('\n');
+        return i == std::string_view::npos ? 0 : i + 1;
+    }
+};
+
+// Day 0's input is a single line, but its numbers have nothing to do with each other, so it can be cut after any byte
+// that isn't a digit. Otherwise an input of more than one chunk couldn't be streamed at all.
+template <>
+struct line_streaming<0> {
+    static constexpr bool supported = true;
+    using merge1 = std::plus<>;
+    using merge2 = std::multiplies<>;
+
+    static std::size_t cut(std::string_view text) {
+        const auto i = text.find_last_not_of("0123456789");
+        return i == std::string_view::npos ? 0 : i + 1;
+    }
+};
+
+template <>
+struct line_streaming<2> : cut_at_lines {
+    static constexpr bool supported = true;
+    using merge1 = std::plus<>;
+    using merge2 = std::plus<>;
+};
+
+template <>
+struct line_streaming<7> : cut_at_lines {
+    static constexpr bool supported = true;
+    using merge1 = std::plus<>;
+    using merge2 = std::plus<>;
+};
+
+// The engine_sets (see engine.h) of the parts that have more than one implementation, for the driver to time against
+// each other. part1 and part2 point to them, or are nullptr for a part with only the one.
+template <long N>
+struct day_engines {
+    static constexpr std::nullptr_t part1 = nullptr, part2 = nullptr;
+};
+
+template <>
+struct day_engines<2> {
+    static constexpr const auto *part1 = &day2::part1_engines;
+    static constexpr const auto *part2 = &day2::part2_engines;
+};
+
+template <>
+struct day_engines<5> {
+    static constexpr const auto *part1 = &day5::part1_engines;
+    static constexpr const auto *part2 = &day5::part2_engines;
+};
+
+template <>
+struct day_engines<6> {
+    static constexpr const auto *part1 = &day6::part1_engines;
+    static constexpr std::nullptr_t part2 = nullptr;
+};
+
+template <>
+struct day_engines<7> {
+    static constexpr const auto *part1 = &day7::part1_engines;
+    static constexpr const auto *part2 = &day7::part2_engines;
+};
+
+// Estimates of how much memory each day's parsed input takes up, for the days whose Input is a struct. Every other
+// Input type is covered by footprint.h already.
+namespace day1 {
+inline std::size_t footprint(const Input &input) {
+    return ::footprint(input.left) + ::footprint(input.right);
+}
+} // namespace day1
+
+namespace day5 {
+template <class Page>
+std::size_t footprint(const Pages<Page> &pages) {
+    return ::footprint(pages.rules) + ::footprint(pages.updates);
+}
+} // namespace day5
+
+namespace day6 {
+inline std::size_t footprint(const Input &input) {
+    return ::footprint(input.walls) + ::footprint(input.start);
+}
+} // namespace day6
+
+namespace day7 {
+inline std::size_t footprint(const Input &input) {
+    return ::footprint(input.answers) + ::footprint(input.operands);
+}
+} // namespace day7
+
+namespace day8 {
+inline std::size_t footprint(const Input &input) {
+    return ::footprint(input.height) + ::footprint(input.width) + ::footprint(input.antennae);
+}
+} // namespace day8
+
+// How the days whose Input is a struct are written to and read back from the on-disk parse cache. The cache tells
+// Input types apart by their names, so bump input_schema_version whenever the members of one of these structs change.
+constexpr std::uint64_t input_schema_version = 3;
+
+namespace day1 {
+inline void serialize(byte_writer &w, const Input &input) {
+    ::serialize(w, input.left);
+    ::serialize(w, input.right);
+}
+
+inline Input deserialize(byte_reader &r, type_tag<Input>) {
+    Input input;
+    input.left = ::deserialize(r, type_tag<decltype(input.left)>{});
+    input.right = ::deserialize(r, type_tag<decltype(input.right)>{});
+    return input;
+}
+} // namespace day1
+
+namespace day5 {
+template <class Page>
+void serialize(byte_writer &w, const Pages<Page> &pages) {
+    ::serialize(w, pages.rules);
+    ::serialize(w, pages.updates);
+}
+
+template <class Page>
+Pages<Page> deserialize(byte_reader &r, type_tag<Pages<Page>>) {
+    Pages<Page> pages;
+    pages.rules = ::deserialize(r, type_tag<decltype(pages.rules)>{});
+    pages.updates = ::deserialize(r, type_tag<decltype(pages.updates)>{});
+    return pages;
+}
+} // namespace day5
+
+namespace day6 {
+inline void serialize(byte_writer &w, const Input &input) {
+    ::serialize(w, input.walls);
+    ::serialize(w, input.start);
+}
+
+inline Input deserialize(byte_reader &r, type_tag<Input>) {
+    auto walls = ::deserialize(r, type_tag<bit_matrix>{});
+    const auto start = ::deserialize(r, type_tag<decltype(Input::start)>{});
+    return Input{std::move(walls), start};
+}
+} // namespace day6
+
+namespace day7 {
+inline void serialize(byte_writer &w, const Input &input) {
+    ::serialize(w, input.answers);
+    ::serialize(w, input.operands);
+}
+
+inline Input deserialize(byte_reader &r, type_tag<Input>) {
+    Input input;
+    input.answers = ::deserialize(r, type_tag<decltype(input.answers)>{});
+    input.operands = ::deserialize(r, type_tag<decltype(input.operands)>{});
+    if (input.answers.size() != input.operands.size())
+        throw std::runtime_error{"day 7 answers and operands don't match up"};
+    return input;
+}
+} // namespace day7
+
+namespace day8 {
+inline void serialize(byte_writer &w, const Input &input) {
+    ::serialize(w, input.height);
+    ::serialize(w, input.width);
+    ::serialize(w, input.antennae);
+}
+
+inline Input deserialize(byte_reader &r, type_tag<Input>) {
+    Input input;
+    input.height = ::deserialize(r, type_tag<decltype(input.height)>{});
+    input.width = ::deserialize(r, type_tag<decltype(input.width)>{});
+    input.antennae = ::deserialize(r, type_tag<decltype(input.antennae)>{});
+    return input;
+}
+} // namespace day8
+
+// Calls f(Day{}) for every day in the registry, in order.
+template <class F>
+void for_each_day(F &&f) {
+    std::apply(
+        [&f](auto... days) {
+            (f(days), ...);
+        },
+        registry{});
+}
+
+// Calls f(Day{}) for the day numbered n. Returns false if that day hasn't been done yet.
+template <class F>
+bool with_day(long n, F &&f) {
+    return std::apply(
+        [n, &f](auto... days) {
+            return ((decltype(days)::number == n ? (f(days), true) : false) || ...);
+        },
+        registry{});
+}
+
+} // namespace aoc
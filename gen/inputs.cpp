@@ -0,0 +1,710 @@
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <type_traits>
+
+#include "days.h"
+#endif
+
+#include "inputs.h"
+
+namespace aoc::gen {
+
+namespace {
+
+// Collects output in a buffer and writes it out in large blocks, which is a lot faster than many small writes to an
+// ostream when there are gigabytes of it
+class writer {
+    std::ostream &out;
+    std::vector<char> buffer;
+    static constexpr std::size_t block_size = 1 << 16;
+
+public:
+    explicit writer(std::ostream &out) : out{out} {
+        buffer.reserve(block_size + 64);
+    }
+    writer(const writer &other) = delete;
+    ~writer() {
+        flush();
+    }
+
+    writer &operator=(const writer &other) = delete;
+
+    void put(char c) {
+        buffer.push_back(c);
+        if (buffer.size() >= block_size)
+            flush();
+    }
+
+    void put(std::string_view s) {
+        buffer.insert(std::end(buffer), std::begin(s), std::end(s));
+        if (buffer.size() >= block_size)
+            flush();
+    }
+
+    void number(std::uint64_t n) {
+        char digits[20];
+        const auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), n);
+        put(std::string_view{digits, static_cast<std::size_t>(end - digits)});
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+};
+
+template <class T>
+void shuffle(std::vector<T> &v, rng &r) {
+    for (auto i = v.size(); i > 1; i--)
+        std::swap(v[i - 1], v[r.below(i)]);
+}
+
+// Space-separated numbers on one line
+void write_day0(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        if (i)
+            w.put(' ');
+        w.number(r.below(1000));
+    }
+    w.put('\n');
+}
+
+// Pairs of five-digit numbers. A quarter of each list comes from a shared pool, so that part 2 finds numbers in common.
+void write_day1(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    std::vector<std::uint64_t> pool(std::clamp<std::size_t>(opts.scale / 4, 1, 1 << 16));
+    for (auto &n : pool)
+        n = r.between(10000, 99999);
+    const auto pick = [&r, &pool] {
+        return r.one_in(4) ? pool[r.below(pool.size())] : r.between(10000, 99999);
+    };
+
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        w.number(pick());
+        w.put("   ");
+        w.number(pick());
+        w.put('\n');
+    }
+}
+
+// Reports of up to width levels, going steadily up or down. Half of them have a bad step somewhere, and a quarter of
+// those a second one, so that the problem dampener can save some but not all of them.
+void write_day2(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    const auto width = std::max<std::size_t>(opts.width, 2);
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        const auto n = r.between(width > 5 ? width - 3 : 2, width);
+        const auto up = r.one_in(2);
+        // Far enough from 0 that a report going down never gets there, even with the biggest bad steps
+        auto level = 6 * n + r.between(1, 90);
+        const auto bad_steps = r.one_in(2) ? (r.one_in(4) ? 2 : 1) : 0;
+        std::size_t bad[2] = {r.between(1, n - 1), r.between(1, n - 1)};
+
+        for (std::size_t l = 0; l < n; l++) {
+            if (l) {
+                auto step = static_cast<std::int64_t>(r.between(1, 3));
+                if ((bad_steps > 0 && l == bad[0]) || (bad_steps > 1 && l == bad[1])) {
+                    switch (r.below(3)) {
+                    case 0: step = 0; break;
+                    case 1: step = static_cast<std::int64_t>(r.between(4, 6)); break;
+                    default: step = -step; break; // The wrong way
+                    }
+                }
+                level = static_cast<std::uint64_t>(static_cast<std::int64_t>(level) + (up ? step : -step));
+                w.put(' ');
+            }
+            w.number(level);
+        }
+        w.put('\n');
+    }
+}
+
+// The worst case for the problem dampener: every report is width levels long and goes steadily up or down until its
+// last two steps, which are both bad (two repeats, or two jumps of 4 to 6), so that it is unsafe and stays unsafe with
+// any one level removed. Every removal has to be tried, and each of those checks gets to the end before failing.
+void write_day2_worst_case(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    const auto n = std::max<std::size_t>(opts.width, 4);
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        const auto up = r.one_in(2), repeats = r.one_in(2);
+        auto level = up ? r.between(1, 9) : 3 * n + r.between(10, 19);
+        for (std::size_t l = 0; l < n; l++) {
+            if (l) {
+                const auto step = l < n - 2 ? r.between(1, 3) : repeats ? 0 : r.between(4, 6);
+                level = up ? level + step : level - step;
+                w.put(' ');
+            }
+            w.number(level);
+        }
+        w.put('\n');
+    }
+}
+
+// About scale bytes of corrupted memory: junk, well-formed and malformed mul()s, other instructions with and without
+// arguments, and do()s and don't()s, in lines of a few thousand bytes
+void write_day3(std::ostream &out, const options &opts) {
+    static constexpr std::string_view junk = "^+'*>,()@<$-#~%&:;[]{}/! ?", words[] = {
+        "why", "select", "what", "who", "how", "from", "when", "where"};
+    writer w{out};
+    rng r{opts.seed};
+    std::size_t written = 0, line = 0;
+    const auto put = [&w, &written, &line](std::string_view s) {
+        w.put(s);
+        written += s.size();
+        line += s.size();
+    };
+    const auto put_number = [&put](std::uint64_t n) {
+        put(std::to_string(n));
+    };
+
+    while (written < opts.scale) {
+        const auto choice = r.below(20);
+        if (choice < 8) {
+            for (auto n = r.between(1, 4); n > 0; n--)
+                put(junk.substr(r.below(junk.size()), 1));
+        } else if (choice < 13) {
+            put("mul(");
+            put_number(r.between(1, 999));
+            put(",");
+            put_number(r.between(1, 999));
+            put(")");
+        } else if (choice == 13) {
+            // Near misses, none of which count
+            static constexpr std::string_view openings[] = {"mul[", "mul (", "mul(", "mul(", "mil("},
+                                              closings[] = {"]", ")", ")", " ", ")"};
+            const auto k = r.below(std::size(openings));
+            put(openings[k]);
+            put_number(k == 2 ? r.between(1000, 9999) : r.between(1, 999));
+            put(",");
+            put_number(r.between(1, 999));
+            put(closings[k]);
+        } else if (choice < 16) {
+            put(words[r.below(std::size(words))]);
+            put("(");
+            if (r.one_in(3)) {
+                put_number(r.between(1, 999));
+                put(",");
+                put_number(r.between(1, 999));
+            }
+            put(")");
+        } else if (choice == 16) {
+            put("do()");
+        } else if (choice == 17) {
+            put("don't()");
+        } else if (line > 3000) {
+            put("\n");
+            line = 0;
+        }
+    }
+    w.put('\n');
+}
+
+// A square grid of the letters in XMAS
+void write_day4(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    for (std::size_t row = 0; row < opts.scale; row++) {
+        for (std::size_t col = 0; col < opts.scale; col++)
+            w.put("XMAS"[r.below(4)]);
+        w.put('\n');
+    }
+}
+
+// Writes a rule for every pair of n pages, numbered from 10, so that they are in a total order, and returns that order.
+// The rules come out page by page, in no particular order of either page.
+std::vector<std::uint64_t> write_total_order(writer &w, rng &r, std::size_t n) {
+    std::vector<std::uint64_t> order(n);
+    for (std::size_t i = 0; i < n; i++)
+        order[i] = 10 + i;
+    shuffle(order, r);
+
+    std::vector<std::size_t> firsts(n);
+    for (std::size_t i = 0; i < n; i++)
+        firsts[i] = i;
+    shuffle(firsts, r);
+    std::vector<std::uint64_t> seconds;
+    for (const auto i : firsts) {
+        seconds.assign(std::begin(order) + static_cast<std::ptrdiff_t>(i) + 1, std::end(order));
+        shuffle(seconds, r);
+        for (const auto page : seconds) {
+            w.number(order[i]);
+            w.put('|');
+            w.number(page);
+            w.put('\n');
+        }
+    }
+    w.put('\n');
+    return order;
+}
+
+// Each page's position in order, indexed by the page less 10
+std::vector<std::size_t> ranks(const std::vector<std::uint64_t> &order) {
+    std::vector<std::size_t> rank(order.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        rank[order[i] - 10] = i;
+    return rank;
+}
+
+void sort_pages(std::vector<std::uint64_t> &update, const std::vector<std::size_t> &rank) {
+    std::sort(std::begin(update), std::end(update), [&rank](std::uint64_t a, std::uint64_t b) {
+        return rank[a - 10] < rank[b - 10];
+    });
+}
+
+void write_update(writer &w, const std::vector<std::uint64_t> &update) {
+    for (std::size_t k = 0; k < update.size(); k++) {
+        if (k)
+            w.put(',');
+        w.number(update[k]);
+    }
+    w.put('\n');
+}
+
+// Picks size of the n pages at random, by shuffling the front of pages, which stays a permutation of all of them
+void draw_pages(std::vector<std::uint64_t> &pages, std::size_t size, rng &r, std::vector<std::uint64_t> &update) {
+    update.clear();
+    for (std::size_t k = 0; k < size; k++) {
+        std::swap(pages[k], pages[k + r.below(pages.size() - k)]);
+        update.push_back(pages[k]);
+    }
+}
+
+// scale pages with a rule for every pair of them, then 4 * scale updates of up to width pages each (an odd number, so
+// there is a middle page), half of them in the right order
+void write_day5(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    const auto n = std::max<std::size_t>(opts.scale, 1);
+    const auto order = write_total_order(w, r, n);
+    const auto rank = ranks(order);
+
+    std::vector<std::uint64_t> pages{order};
+    std::vector<std::uint64_t> update;
+    const auto width = std::min(std::max<std::size_t>(opts.width, 1), n);
+    for (std::size_t u = 0; u < 4 * n; u++) {
+        auto size = r.between(std::min<std::size_t>(5, width), width);
+        if (size % 2 == 0)
+            size--;
+        draw_pages(pages, size, r, update);
+        if (r.one_in(2))
+            sort_pages(update, rank);
+        write_update(w, update);
+    }
+}
+
+// The worst case for checking and reordering updates: every update is as wide as width allows, and a third of them
+// are in order, which is_correct_order() has to check all the way through, a third are in reverse order, and a third
+// are in order but for the last two pages, so that the check only fails at the end and the update is then reordered
+void write_day5_worst_case(std::ostream &out, const options &opts) {
+    writer w{out};
+    rng r{opts.seed};
+    const auto n = std::max<std::size_t>(opts.scale, 3);
+    const auto order = write_total_order(w, r, n);
+    const auto rank = ranks(order);
+
+    std::vector<std::uint64_t> pages{order};
+    std::vector<std::uint64_t> update;
+    auto size = std::min(std::max<std::size_t>(opts.width, 3), n);
+    if (size % 2 == 0)
+        size--;
+    for (std::size_t u = 0; u < 4 * n; u++) {
+        draw_pages(pages, size, r, update);
+        sort_pages(update, rank);
+        if (u % 3 == 1)
+            std::reverse(std::begin(update), std::end(update));
+        else if (u % 3 == 2)
+            std::swap(update[size - 2], update[size - 1]);
+        write_update(w, update);
+    }
+}
+
+// Knocks down walls that trap the guard, starting from cell start of the n by n grid of walls and going north, in a
+// loop, until its walk leads out of the grid, as part 1 needs
+void clear_loops(std::vector<bool> &walls, std::size_t n, std::size_t start) {
+    // Walks the guard out, or returns the wall whose second bump going the same way shows it is going round in circles
+    const auto trapping_wall = [n, start, &walls]() -> std::size_t {
+        constexpr int row_step[] = {-1, 0, 1, 0}, col_step[] = {0, 1, 0, -1};
+        std::unordered_set<std::size_t> bumps;
+        auto row = start / n, col = start % n;
+        std::size_t direction = 0;
+        for (;;) {
+            const auto next_row = row + row_step[direction], next_col = col + col_step[direction];
+            if (next_row >= n || next_col >= n)
+                return n * n;
+            if (walls[next_row * n + next_col]) {
+                if (!bumps.insert((next_row * n + next_col) * 4 + direction).second)
+                    return next_row * n + next_col;
+                direction = (direction + 1) % 4;
+            } else {
+                row = next_row;
+                col = next_col;
+            }
+        }
+    };
+    for (auto wall = trapping_wall(); wall != n * n; wall = trapping_wall())
+        walls[wall] = false;
+}
+
+void write_grid(std::ostream &out, const std::vector<bool> &walls, std::size_t n, std::size_t start) {
+    writer w{out};
+    for (std::size_t i = 0; i < n * n; i++) {
+        w.put(i == start ? '^' : walls[i] ? '#' : '.');
+        if (i % n == n - 1)
+            w.put('\n');
+    }
+}
+
+// A square grid with one cell in 20 an obstruction, like the real inputs, and the guard somewhere in it
+void write_day6(std::ostream &out, const options &opts) {
+    rng r{opts.seed};
+    const auto n = std::max<std::size_t>(opts.scale, 1);
+    std::vector<bool> walls(n * n);
+    for (std::size_t i = 0; i < n * n; i++)
+        walls[i] = r.one_in(20);
+    const auto start = r.below(n * n);
+    walls[start] = false;
+    clear_loops(walls, n, start);
+    write_grid(out, walls, n, start);
+}
+
+// The worst case for part 2: the guard starts in the bottom left corner and spirals inwards, turning right at a wall
+// at the end of each leg, in lanes two apart, so that its walk takes in nearly half the grid. At nearly every step
+// there is a wall ahead of where it would turn to, so part 2 simulates another walk round the rest of the spiral.
+void write_day6_worst_case(std::ostream &out, const options &opts) {
+    const auto n = static_cast<long>(std::max<std::size_t>(opts.scale, 4));
+    std::vector<bool> walls(static_cast<std::size_t>(n * n));
+    const auto wall = [n, &walls](long row, long col) {
+        walls[static_cast<std::size_t>(row * n + col)] = true;
+    };
+
+    // How far each leg goes before the next wall in its direction, which comes 2 nearer the middle after each lap
+    long top = 1, right = n - 2, bottom = n - 2, left = 2, row = n - 1, col = 0;
+    for (;;) {
+        if (row - top < 1)
+            break;
+        wall(top - 1, col);
+        row = top;
+        top += 2;
+        if (right - col < 1)
+            break;
+        wall(row, right + 1);
+        col = right;
+        right -= 2;
+        if (bottom - row < 1)
+            break;
+        wall(bottom + 1, col);
+        row = bottom;
+        bottom -= 2;
+        if (col - left < 1)
+            break;
+        wall(row, left - 1);
+        col = left;
+        left += 2;
+    }
+
+    const auto start = static_cast<std::size_t>((n - 1) * n);
+    clear_loops(walls, static_cast<std::size_t>(n), start);
+    write_grid(out, walls, static_cast<std::size_t>(n), start);
+}
+
+// Equations of up to width operands, mostly one digit with some of two and three. Each answer is what some choice of
+// operators makes of the operands, with concatenation among them for only half the equations, but half are then nudged
+// off it, which leaves most of those with no solution at all.
+void write_day7(std::ostream &out, const options &opts) {
+    // The real answers have up to 15 digits. Keeping to that means the totals can't overflow with fewer than 18000
+    // equations, and usually take far more.
+    constexpr std::uint64_t limit = 1'000'000'000'000'000ULL;
+    writer w{out};
+    rng r{opts.seed};
+    const auto width = std::max<std::size_t>(opts.width, 2);
+    std::vector<std::uint64_t> operands;
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        operands.resize(r.between(width > 11 ? width - 9 : 2, width));
+        for (auto &x : operands) {
+            const auto digits = r.below(10);
+            x = digits < 6 ? r.between(1, 9) : digits < 9 ? r.between(10, 99) : r.between(100, 999);
+        }
+
+        const auto concatenate = r.one_in(2);
+        auto answer = operands[0];
+        for (std::size_t k = 1; k < operands.size(); k++) {
+            const auto x = operands[k];
+            std::uint64_t shift = 10;
+            while (shift <= x)
+                shift *= 10;
+            switch (r.below(concatenate ? 3 : 2)) {
+            case 0:
+                if (answer <= limit / x) {
+                    answer *= x;
+                    break;
+                }
+                [[fallthrough]];
+            case 1: answer += x; break;
+            default:
+                if (answer <= limit / shift)
+                    answer = answer * shift + x;
+                else
+                    answer += x;
+            }
+        }
+        if (r.one_in(2))
+            answer += r.between(1, 9);
+
+        w.number(answer);
+        w.put(':');
+        for (const auto x : operands) {
+            w.put(' ');
+            w.number(x);
+        }
+        w.put('\n');
+    }
+}
+
+// The worst case for both searches. Equations of up to 15 operands alternate between two kinds. In the first the
+// operands are digits from 3 to 9 and the answer is all of them concatenated, which is bigger than any other choice of
+// operators can make, so that can_be_true() only finds it at the very last of the 3^(n-1) results it works out, and
+// with + and * alone can't make it at all. In the second, which is all there is past 15 operands, every operand is 1
+// and the answer, 10^18 + 1, is out of reach; dividing by 1 and taking 1 away both go on as far as the backward search
+// can, so it too has to try at least 2^(n-1) choices before giving up.
+void write_day7_worst_case(std::ostream &out, const options &opts) {
+    constexpr std::uint64_t unreachable = 1'000'000'000'000'000'001ULL;
+    writer w{out};
+    rng r{opts.seed};
+    const auto n = std::max<std::size_t>(opts.width, 2);
+    std::vector<std::uint64_t> operands(n);
+    for (std::size_t i = 0; i < opts.scale; i++) {
+        std::uint64_t answer = 0;
+        if (i % 2 == 0 && n <= 15) {
+            for (auto &x : operands) {
+                x = r.between(3, 9);
+                answer = answer * 10 + x;
+            }
+        } else {
+            std::fill(std::begin(operands), std::end(operands), 1);
+            answer = unreachable;
+        }
+
+        w.number(answer);
+        w.put(':');
+        for (const auto x : operands) {
+            w.put(' ');
+            w.number(x);
+        }
+        w.put('\n');
+    }
+}
+
+// A square grid with about one cell in 15 an antenna, of any of the 62 frequencies. Day 8 keeps coordinates in bytes,
+// hence its max_scale of 255.
+void write_day8(std::ostream &out, const options &opts) {
+    static constexpr std::string_view frequencies = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    writer w{out};
+    rng r{opts.seed};
+    for (std::size_t row = 0; row < opts.scale; row++) {
+        for (std::size_t col = 0; col < opts.scale; col++)
+            w.put(r.one_in(15) ? frequencies[r.below(frequencies.size())] : '.');
+        w.put('\n');
+    }
+}
+
+} // namespace
+
+// Good solutions parse in time linear in the size of the input, and most parts are linear too. Day 5's updates grow
+// with the square root of its input, whose bulk is a rule for every pair of pages, and so should the time it takes to
+// check and reorder them. How far day 6's guard walks on a random map is down to chance, so it is timed on the spiral,
+// whose walk takes in half the map: part 1 is linear, and part 2 has a candidate obstruction for every step, each
+// needing a walk of a turn or so per row, which is no worse than size^1.5 for a solution that skips from wall to wall.
+// Day 8 pairs up every two antennae of a frequency. Day 6 starts small, as its spiral makes each part 2 slow.
+const generator generators[] = {
+    {0, "numbers", "unused", 11, 0, 0, 0, false, {1, 1, 1}, write_day0, nullptr},
+    {1, "lines", "unused", 1000, 0, 0, 0, false, {1, 1, 1}, write_day1, nullptr},
+    {2, "reports", "levels per report", 1000, 8, 0, 0, false, {1, 1, 1}, write_day2, write_day2_worst_case},
+    {3, "bytes", "unused", 18000, 0, 0, 0, false, {1, 1, 1}, write_day3, nullptr},
+    {4, "rows and columns", "unused", 140, 0, 0, 0, false, {1, 1, 1}, write_day4, nullptr},
+    {5, "pages (with a rule for every pair)", "pages per update", 49, 23, 0, 0, false, {1, 0.5, 0.5}, write_day5,
+     write_day5_worst_case},
+    {6, "rows and columns", "unused", 130, 0, 0, 16, true, {1, 1, 1.5}, write_day6, write_day6_worst_case},
+    {7, "equations", "operands per equation", 850, 12, 0, 0, false, {1, 1, 1}, write_day7, write_day7_worst_case},
+    {8, "rows and columns", "unused", 50, 0, 255, 0, false, {1, 2, 2}, write_day8, nullptr},
+};
+
+const std::size_t generator_count = std::size(generators);
+
+const generator *find_generator(long day) {
+    for (const auto &g : generators)
+        if (g.day == day)
+            return &g;
+    return nullptr;
+}
+
+#ifdef TESTING
+namespace {
+
+std::string generate(long day, std::size_t scale, std::uint64_t seed, std::size_t width = 0, bool worst_case = false) {
+    const auto *const g = find_generator(day);
+    REQUIRE(g);
+    const auto write = worst_case ? g->write_worst_case : g->write;
+    REQUIRE(write);
+    std::ostringstream out;
+    write(out, options{scale, width ? width : g->default_width, seed});
+    return out.str();
+}
+
+// Set is a pointer to an engine_set, or nullptr_t for a part that has only the one engine
+template <class Set, class Input>
+void check_engines_agree(Set engines, const Input &input) {
+    if constexpr (!std::is_null_pointer_v<Set>)
+        for (std::size_t i = 1; i < engine_count; i++)
+            CHECK(engines->variant(static_cast<engine>(i))(input) == engines->variant(engine::Reference)(input));
+}
+
+} // namespace
+
+TEST_CASE("generated inputs", "[gen]") {
+    SECTION("the same seed gives the same input, and another seed another one") {
+        for (std::size_t i = 0; i < generator_count; i++) {
+            const auto day = generators[i].day;
+            INFO("day " << day);
+            CHECK(generate(day, 30, 1) == generate(day, 30, 1));
+            CHECK(generate(day, 30, 1) != generate(day, 30, 2));
+        }
+    }
+
+    SECTION("inputs are the size asked for") {
+        const auto day1 = generate(1, 500, 3);
+        CHECK(std::count(std::begin(day1), std::end(day1), '\n') == 500);
+        const auto day3 = generate(3, 10000, 3);
+        CHECK(day3.size() >= 10000);
+        CHECK(day3.size() < 10100);
+        const auto day4 = generate(4, 40, 3);
+        CHECK(day4.size() == 40 * 41);
+    }
+
+    SECTION("every day's input parses, and every engine agrees on it") {
+        for_each_day([](auto d) {
+            using Day = decltype(d);
+            const auto text = generate(Day::number, 60, 42);
+            INFO("day " << Day::number);
+            auto input = Day::parse(text);
+            check_engines_agree(day_engines<Day::number>::part1, input);
+            check_engines_agree(day_engines<Day::number>::part2, input);
+            Day::part1(input);
+            Day::part2(input);
+        });
+    }
+
+    SECTION("day 2 has both safe and unsafe reports, and day 7 both true and false equations") {
+        const auto reports = day2::parse_input(generate(2, 400, 5));
+        const auto safe = day2::part1(reports), dampened = day2::part2(reports);
+        CHECK(safe > 50);
+        CHECK(dampened > safe);
+        CHECK(dampened < 350);
+
+        const auto equations = day7::parse_input(generate(7, 200, 5));
+        std::size_t true_ones = 0, true_with_concatenation = 0;
+        for (std::size_t i = 0; i < equations.size(); i++) {
+            true_ones += equations[i].can_be_true(false);
+            true_with_concatenation += equations[i].can_be_true(true);
+        }
+        CHECK(true_ones > 10);
+        CHECK(true_with_concatenation > true_ones);
+        CHECK(true_with_concatenation < 190);
+    }
+
+    SECTION("day 5's updates are half in order, and day 7 can be given long equations") {
+        const auto pages = day5::parse_input(generate(5, 100, 6));
+        const auto &narrow_pages = std::get<day5::Pages<std::uint8_t>>(pages);
+        std::size_t rules = 0;
+        for (const auto &[page, after] : narrow_pages.rules)
+            rules += after.size();
+        CHECK(rules == 100 * 99 / 2);
+        CHECK(narrow_pages.updates.size() == 400);
+        CHECK(day5::part1(pages) > 0);
+        CHECK(day5::part2(pages) > 0);
+
+        const auto equations = day7::parse_input(generate(7, 50, 6, 25));
+        for (std::size_t i = 0; i < equations.size(); i++)
+            CHECK(equations.operands[i].size() >= 16);
+    }
+
+    SECTION("days that --scaling times on their worst case have one, and start within their max_scale") {
+        for (std::size_t i = 0; i < generator_count; i++) {
+            const auto &g = generators[i];
+            INFO("day " << g.day);
+            CHECK((!g.scale_worst_case || g.write_worst_case));
+            CHECK((!g.max_scale || g.scaling_start <= g.max_scale));
+        }
+    }
+}
+
+TEST_CASE("worst-case inputs", "[gen]") {
+    SECTION("every day's worst case parses, and every engine agrees on it") {
+        for_each_day([](auto d) {
+            using Day = decltype(d);
+            if (!find_generator(Day::number)->write_worst_case)
+                return;
+            INFO("day " << Day::number);
+            auto input = Day::parse(generate(Day::number, 30, 42, 8, true));
+            check_engines_agree(day_engines<Day::number>::part1, input);
+            check_engines_agree(day_engines<Day::number>::part2, input);
+        });
+    }
+
+    SECTION("no day 2 report is safe, even with the problem dampener") {
+        const auto reports = day2::parse_input(generate(2, 300, 7, 10, true));
+        CHECK(std::get<day2::Reports<std::uint8_t>>(reports)[0].size() == 10);
+        CHECK(day2::part1(reports) == 0);
+        CHECK(day2::part2(reports) == 0);
+    }
+
+    SECTION("day 5's updates are all as wide as they can be, and a third of them are in order") {
+        const auto pages = day5::parse_input(generate(5, 60, 7, 15, true));
+        const auto &updates = std::get<day5::Pages<std::uint8_t>>(pages).updates;
+        for (std::size_t i = 0; i < updates.size(); i++)
+            CHECK(updates[i].size() == 15);
+        std::uint32_t in_order = 0;
+        for (std::size_t i = 0; i < updates.size(); i += 3)
+            in_order += updates[i][7];
+        CHECK(day5::part1(pages) == in_order);
+    }
+
+    SECTION("day 6's guard walks round nearly half the grid before leaving it") {
+        for (const std::size_t n : {4, 5, 40, 41}) {
+            INFO(n << " by " << n);
+            const auto input = day6::parse_input(generate(6, n, 7, 0, true));
+            CHECK(day6::part1_engines.variant(engine::Serial)(input) >= n * (n - 2) / 2);
+        }
+    }
+
+    SECTION("day 7's equations can only be made by concatenating everything, or not at all") {
+        const auto equations = day7::parse_input(generate(7, 40, 7, 9, true));
+        std::uint64_t concatenated = 0;
+        for (std::size_t i = 0; i < equations.size(); i += 2)
+            concatenated += equations.answers[i];
+        CHECK(day7::part1(equations) == 0);
+        CHECK(day7::part2(equations) == concatenated);
+
+        const auto long_equations = day7::parse_input(generate(7, 4, 7, 24, true));
+        for (std::size_t i = 0; i < long_equations.size(); i++) {
+            CHECK(long_equations.answers[i] == 1'000'000'000'000'000'001ULL);
+            CHECK(long_equations.operands[i].size() == 24);
+        }
+    }
+}
+#endif
+
+} // namespace aoc::gen
@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#pragma once
+
+// Generators of well-formed puzzle inputs of any size, for reproducing how the days scale far beyond the inputs in
+// fixtures/. Each day's generator takes a scale, the number of its main records (lines, reports, grid rows and so on),
+// and for the days whose records vary in length a width, the most items one record may have; the same day, scale,
+// width and seed always give the same bytes, on any platform. Inputs are written out as they are generated, so even
+// multi-gigabyte ones take next to no memory, except for the grids and rule sets that have to be checked whole.
+namespace aoc::gen {
+
+struct options {
+    std::size_t scale;
+    std::size_t width;
+    std::uint64_t seed;
+};
+
+struct generator {
+    long day;
+    // What scale and width count, for the help message
+    const char *scale_meaning;
+    const char *width_meaning;
+    std::size_t default_scale;
+    std::size_t default_width;
+    // The biggest scale the day's solutions can take, or 0 if there is no limit
+    std::size_t max_scale;
+    // The scale aoc2024 --scaling starts from, or 0 for the smallest from the default up that gives an input big enough
+    // to time reliably
+    std::size_t scaling_start;
+    // Whether --scaling times write_worst_case's inputs rather than write's, for days whose realistic inputs give work
+    // that varies too much from one scale to the next to fit how it grows (day 6's random walks)
+    bool scale_worst_case;
+    // How the time to parse the input, part 1 and part 2 ought to grow with the size in bytes of the inputs that
+    // --scaling times, as the exponent k of size^k, for it to compare the times it measures against
+    double expected_growth[3];
+    void (*write)(std::ostream &out, const options &opts);
+    // Writes an input of the same scale and width aimed at the worst case of the day's solvers instead of a realistic
+    // one, for finding out how big an input they can take; nullptr for days without one
+    void (*write_worst_case)(std::ostream &out, const options &opts);
+};
+
+// The generator for day, or nullptr if there isn't one
+const generator *find_generator(long day);
+
+// Every day's generator, in order of day
+extern const generator generators[];
+extern const std::size_t generator_count;
+
+// A splitmix64 generator. The <random> distributions are implemented differently by different standard libraries,
+// which would make the same seed give different inputs, so generators draw from this instead.
+class rng {
+    std::uint64_t state;
+
+public:
+    explicit rng(std::uint64_t seed) : state{seed} {}
+
+    std::uint64_t next() {
+        auto z = state += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, n), for n > 0, by Lemire's multiply-shift (the slight bias is of no consequence here)
+    std::uint64_t below(std::uint64_t n) {
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+
+    // Uniform in [lo, hi]
+    std::uint64_t between(std::uint64_t lo, std::uint64_t hi) {
+        return lo + below(hi - lo + 1);
+    }
+
+    // True one time in n
+    bool one_in(std::uint64_t n) {
+        return below(n) == 0;
+    }
+};
+
+} // namespace aoc::gen
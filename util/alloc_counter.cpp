@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <memory>
+#include <vector>
+#endif
+
+#include "alloc_counter.h"
+
+// Only compiled in when AOC_COUNT_ALLOCATIONS is set. Every block handed out by operator new is preceded by a header
+// recording its size so that operator delete knows how much is no longer live. The counters are per thread so that
+// concurrently running days don't get charged for each other's allocations; a block freed on a different thread from
+// the one that allocated it makes that thread's live count dip, which is why it is signed.
+static thread_local std::uint64_t allocations, bytes;
+static thread_local std::int64_t live, peak;
+
+// Keeps the pointers we hand out suitably aligned for anything
+static constexpr std::size_t header_size = alignof(std::max_align_t);
+
+static void *counted_alloc(std::size_t size) noexcept {
+    auto *block = static_cast<unsigned char *>(std::malloc(header_size + size));
+    if (!block)
+        return nullptr;
+    *reinterpret_cast<std::size_t *>(block) = size;
+
+    allocations++;
+    bytes += size;
+    live += size;
+    peak = std::max(peak, live);
+
+    return block + header_size;
+}
+
+static void counted_free(void *p) noexcept {
+    if (!p)
+        return;
+    auto *block = static_cast<unsigned char *>(p) - header_size;
+    live -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+static void *counted_alloc_or_throw(std::size_t size) {
+    // operator new must return a distinct pointer even for zero bytes
+    if (auto *p = counted_alloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size) {
+    return counted_alloc_or_throw(size);
+}
+
+void *operator new[](std::size_t size) {
+    return counted_alloc_or_throw(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return counted_alloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return counted_alloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept {
+    counted_free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    counted_free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    counted_free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    counted_free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    counted_free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    counted_free(p);
+}
+
+void alloc_counter::start() {
+    start_allocations = allocations;
+    start_bytes = bytes;
+    start_live = live;
+    // Measure the peak from here but put back the enclosing measurement's peak afterwards in case they are nested
+    saved_peak = peak;
+    peak = live;
+}
+
+alloc_stats alloc_counter::stop() {
+    alloc_stats stats;
+    stats.allocations = allocations - start_allocations;
+    stats.bytes = bytes - start_bytes;
+    stats.peak_bytes = std::max<std::int64_t>(peak - start_live, 0);
+    peak = std::max(peak, saved_peak);
+    return stats;
+}
+
+#ifdef TESTING
+TEST_CASE("alloc_counter", "[util][alloc_counter]") {
+    SECTION("counts allocations and bytes") {
+        alloc_counter counter;
+        counter.start();
+        {
+            auto a = std::make_unique<std::uint64_t>(1);
+            auto b = std::make_unique<char[]>(100);
+        }
+        const auto stats = counter.stop();
+        CHECK(stats.allocations == 2);
+        CHECK(stats.bytes == sizeof(std::uint64_t) + 100);
+        CHECK(stats.peak_bytes == sizeof(std::uint64_t) + 100);
+    }
+
+    SECTION("peak only counts what is live at the same time") {
+        alloc_counter counter;
+        counter.start();
+        for (auto i = 0; i < 10; i++)
+            std::make_unique<char[]>(1000);
+        const auto stats = counter.stop();
+        CHECK(stats.allocations == 10);
+        CHECK(stats.bytes == 10000);
+        CHECK(stats.peak_bytes == 1000);
+    }
+
+    SECTION("nested counters") {
+        alloc_counter outer, inner;
+        outer.start();
+        std::vector<char> v(5000);
+        inner.start();
+        std::make_unique<char[]>(10);
+        const auto inner_stats = inner.stop();
+        const auto outer_stats = outer.stop();
+        CHECK(inner_stats.allocations == 1);
+        CHECK(inner_stats.peak_bytes == 10);
+        CHECK(outer_stats.allocations == 2);
+        CHECK(outer_stats.peak_bytes == 5010);
+    }
+}
+#endif
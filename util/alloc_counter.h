@@ -0,0 +1,33 @@
+#include <cstdint>
+
+#pragma once
+
+struct alloc_stats {
+    std::uint64_t allocations = 0, bytes = 0, peak_bytes = 0;
+};
+
+// Counts the heap allocations made by the calling thread between start() and stop(): how many there were, how many
+// bytes they asked for in total, and the most bytes that were live at once over and above what was live at start().
+//
+// The counting comes from replacement global operator new/delete functions that only get linked in when building
+// with -DAOC_COUNT_ALLOCATIONS=ON. Otherwise enabled is false and every measurement comes back as zeroes.
+class alloc_counter {
+    std::uint64_t start_allocations = 0, start_bytes = 0;
+    std::int64_t start_live = 0, saved_peak = 0;
+
+public:
+#ifdef AOC_COUNT_ALLOCATIONS
+    static constexpr bool enabled = true;
+
+    void start();
+    alloc_stats stop();
+#else
+    static constexpr bool enabled = false;
+
+    void start() {}
+
+    alloc_stats stop() {
+        return alloc_stats{};
+    }
+#endif
+};
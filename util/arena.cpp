@@ -0,0 +1,83 @@
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <map>
+#include <thread>
+#include <vector>
+#endif
+
+#include "arena.h"
+
+namespace {
+
+// The innermost live arena_scope's resource on this thread, if there is one
+thread_local std::pmr::memory_resource *current = nullptr;
+
+} // namespace
+
+std::pmr::memory_resource *current_arena() {
+    return current ? current : std::pmr::get_default_resource();
+}
+
+arena_scope::arena_scope(std::size_t initial_size) : previous{current} {
+    owned.emplace(initial_size, std::pmr::get_default_resource());
+    installed = current = &*owned;
+}
+
+arena_scope::arena_scope(std::pmr::memory_resource *resource) : installed{resource}, previous{current} {
+    current = installed;
+}
+
+arena_scope::~arena_scope() {
+    current = previous;
+}
+
+#ifdef TESTING
+TEST_CASE("arena_scope", "[util][arena]") {
+    SECTION("outside any scope allocations use the default resource") {
+        CHECK(current_arena() == std::pmr::get_default_resource());
+    }
+
+    SECTION("scopes nest, and each puts back the one before it") {
+        arena_scope outer;
+        CHECK(current_arena() == outer.resource());
+        CHECK(current_arena() != std::pmr::get_default_resource());
+        {
+            arena_scope inner{1024};
+            CHECK(current_arena() == inner.resource());
+            CHECK(inner.resource() != outer.resource());
+        }
+        CHECK(current_arena() == outer.resource());
+    }
+
+    SECTION("an arena owned elsewhere is installed but not released") {
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::vector<int> v{std::pmr::polymorphic_allocator<int>{&arena}};
+        {
+            arena_scope scope{&arena};
+            CHECK(current_arena() == &arena);
+        }
+        v.assign(1000, 42);
+        CHECK(v.back() == 42);
+        CHECK(current_arena() == std::pmr::get_default_resource());
+    }
+
+    SECTION("containers built from arena_allocator() land in the current arena") {
+        arena_scope scope;
+        auto m = std::pmr::map<int, std::pmr::vector<int>>{arena_allocator<std::pmr::map<int, int>::allocator_type>()};
+        m[1].push_back(2);
+        CHECK(m.get_allocator().resource() == scope.resource());
+        // Uses-allocator construction passes the arena on to the elements
+        CHECK(m[1].get_allocator().resource() == scope.resource());
+        CHECK(arena_allocator<std::allocator<int>>() == std::allocator<int>{});
+    }
+
+    SECTION("each thread has its own current arena") {
+        arena_scope scope;
+        std::pmr::memory_resource *other = nullptr;
+        std::thread{[&other] {
+            other = current_arena();
+        }}.join();
+        CHECK(other == std::pmr::get_default_resource());
+    }
+}
+#endif
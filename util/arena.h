@@ -0,0 +1,50 @@
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+
+#pragma once
+
+// Arena allocation for parsing and solving. A run installs an arena on its thread with an arena_scope; parsed inputs
+// and the scratch containers the solutions build allocate from current_arena(), which is a pointer bump rather than a
+// trip through malloc, and free nothing until the scope ends and releases the lot in one go. Outside any scope
+// current_arena() is the default resource, i.e. plain new and delete, so code that never sets one up (tests, say)
+// carries on as before.
+//
+// A monotonic arena never reuses memory that is given back to it, so a container that is rebuilt over and over within
+// one run (e.g. a search queue per candidate answer) wants a std::pmr::unsynchronized_pool_resource on top of
+// current_arena() of its own, which does.
+
+// The resource that whatever is being parsed or solved on this thread should allocate from
+std::pmr::memory_resource *current_arena();
+
+// Makes an arena current on this thread for as long as it is in scope, then puts back whichever was current before.
+// Scopes nest, and must be ended on the thread that began them.
+class arena_scope {
+    std::optional<std::pmr::monotonic_buffer_resource> owned;
+    std::pmr::memory_resource *installed, *previous;
+
+public:
+    // A new arena, which starts with a block of initial_size bytes and releases everything when the scope ends
+    explicit arena_scope(std::size_t initial_size = 64 * 1024);
+    // An arena owned by someone else (e.g. a cache entry that outlives the scope), which the scope doesn't release
+    explicit arena_scope(std::pmr::memory_resource *resource);
+    arena_scope(const arena_scope &other) = delete;
+    ~arena_scope();
+
+    arena_scope &operator=(const arena_scope &other) = delete;
+
+    std::pmr::memory_resource *resource() const {
+        return installed;
+    }
+};
+
+// A default-constructed Allocator, except that polymorphic allocators get current_arena() rather than the default
+// resource. For constructing containers generically (e.g. when deserializing) that should land in the current arena.
+template <class Allocator>
+Allocator arena_allocator() {
+    if constexpr (std::is_constructible_v<Allocator, std::pmr::memory_resource *>)
+        return Allocator{current_arena()};
+    else
+        return Allocator{};
+}
@@ -0,0 +1,173 @@
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#endif
+
+#include "binary_cache.h"
+#include "hash.h"
+
+namespace {
+
+constexpr char magic[8] = {'A', 'O', 'C', 'C', 'A', 'C', 'H', 'E'};
+// Bump whenever the header changes
+constexpr std::uint32_t format_version = 1;
+
+// Every field is eight bytes wide (or two fours) so there's no padding, and the payload after it stays aligned
+struct header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    cache_key key;
+    std::uint64_t payload_size;
+    std::uint64_t payload_hash;
+};
+
+bool operator==(const cache_key &a, const cache_key &b) {
+    return a.day == b.day && a.schema == b.schema && a.input_hash == b.input_hash && a.input_size == b.input_size;
+}
+
+} // namespace
+
+binary_cache::binary_cache(std::string dir, std::string extension)
+    : dir{std::move(dir)}, extension{std::move(extension)} {}
+
+std::string binary_cache::path(const cache_key &key) const {
+    char name[64];
+    std::snprintf(name, sizeof name, "/day%llu-%016llx", static_cast<unsigned long long>(key.day),
+                  static_cast<unsigned long long>(key.input_hash));
+    return dir + name + extension;
+}
+
+std::optional<mapped_file> binary_cache::load(const cache_key &key, std::string_view &payload) const {
+    mapped_file file{path(key).c_str()};
+    if (!file || file.size() < sizeof(header))
+        return std::nullopt;
+
+    header h;
+    std::memcpy(&h, file.data(), sizeof h);
+    if (std::memcmp(h.magic, magic, sizeof magic) != 0 || h.version != format_version || !(h.key == key) ||
+        h.payload_size != file.size() - sizeof h)
+        return std::nullopt;
+
+    const auto p = file.view().substr(sizeof h);
+    if (hash_bytes(p) != h.payload_hash)
+        return std::nullopt;
+
+    payload = p;
+    return std::optional<mapped_file>{std::move(file)};
+}
+
+bool binary_cache::store(const cache_key &key, std::string_view payload) const {
+    if (mkdir(dir.c_str(), 0777) == -1 && errno != EEXIST)
+        return false;
+
+    header h;
+    std::memcpy(h.magic, magic, sizeof magic);
+    h.version = format_version;
+    h.reserved = 0;
+    h.key = key;
+    h.payload_size = payload.size();
+    h.payload_hash = hash_bytes(payload);
+
+    // Unique to this thread, since several threads might be storing the same entry at once
+    const auto final_path = path(key),
+               tmp_path = final_path + ".tmp." + std::to_string(getpid()) + '.' +
+                          std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    auto *f = std::fopen(tmp_path.c_str(), "wb");
+    if (!f)
+        return false;
+    auto ok = std::fwrite(&h, sizeof h, 1, f) == 1 &&
+              std::fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp_path.c_str(), final_path.c_str()) == -1) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+std::size_t binary_cache::clear() const {
+    auto *d = opendir(dir.c_str());
+    if (!d)
+        return 0;
+
+    std::size_t n = 0;
+    while (const auto *entry = readdir(d)) {
+        const std::string_view name{entry->d_name};
+        if (name.size() > extension.size() && name.substr(0, 3) == "day" &&
+            name.substr(name.size() - extension.size()) == extension &&
+            unlink((dir + '/' + entry->d_name).c_str()) == 0)
+            n++;
+    }
+    closedir(d);
+
+    return n;
+}
+
+#ifdef TESTING
+TEST_CASE("binary_cache", "[util][binary_cache]") {
+    char dir[] = "/tmp/aoc2024-binary-cache-XXXXXX";
+    REQUIRE(mkdtemp(dir));
+    const binary_cache cache{std::string{dir} + "/cache"};
+    const cache_key key{1, 2, 3, 4};
+    std::string_view payload;
+
+    SECTION("missing entry") {
+        CHECK(!cache.load(key, payload));
+    }
+
+    SECTION("round trip") {
+        REQUIRE(cache.store(key, "hello"));
+        const auto file = cache.load(key, payload);
+        REQUIRE(file);
+        CHECK(payload == "hello");
+    }
+
+    SECTION("stale entry") {
+        REQUIRE(cache.store(key, "hello"));
+        // Same file name, different schema
+        CHECK(!cache.load(cache_key{1, 5, 3, 4}, payload));
+    }
+
+    SECTION("corrupt entry") {
+        REQUIRE(cache.store(key, "hello"));
+        auto *f = std::fopen(cache.path(key).c_str(), "r+b");
+        REQUIRE(f);
+        std::fseek(f, -1, SEEK_END);
+        std::fputc('!', f);
+        std::fclose(f);
+        CHECK(!cache.load(key, payload));
+
+        // and a rewrite replaces it
+        REQUIRE(cache.store(key, "hello"));
+        CHECK(cache.load(key, payload));
+    }
+
+    SECTION("clear only removes its own entries") {
+        const binary_cache other{std::string{dir} + "/cache", ".other"};
+        REQUIRE(cache.store(key, "hello"));
+        REQUIRE(cache.store(cache_key{2, 2, 3, 4}, "world"));
+        REQUIRE(other.store(key, "hello"));
+        CHECK(cache.clear() == 2);
+        CHECK(!cache.load(key, payload));
+        CHECK(other.load(key, payload));
+        CHECK(other.clear() == 1);
+    }
+
+    std::remove(cache.path(key).c_str());
+    rmdir((std::string{dir} + "/cache").c_str());
+    rmdir(dir);
+}
+#endif
@@ -0,0 +1,42 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+
+#pragma once
+
+// Identifies what a cache entry holds. Entries are found by day and input hash, and the rest is checked when loading
+// them so that an entry written for a different version of a day's Input type, or a hash collision, is never used.
+struct cache_key {
+    std::uint64_t day;
+    // Changes whenever the layout of the serialized value does
+    std::uint64_t schema;
+    std::uint64_t input_hash;
+    std::uint64_t input_size;
+};
+
+// A directory of serialized values, one file per key. Several caches can share a directory as long as their files have
+// different extensions. Each file starts with a header recording its key and a checksum of the value, so stale and
+// corrupt entries can be told apart from good ones, and files are written under a temporary name before being renamed
+// into place so that readers never see one half-written.
+class binary_cache {
+    std::string dir, extension;
+
+public:
+    explicit binary_cache(std::string dir, std::string extension = ".bin");
+
+    std::string path(const cache_key &key) const;
+
+    // Maps the entry for key and points payload at the value stored in it, which stays valid for as long as the
+    // returned file does. Returns nothing if there's no entry for key or if it is stale or corrupt.
+    std::optional<mapped_file> load(const cache_key &key, std::string_view &payload) const;
+
+    // Creates the directory if need be. Returns false if the entry couldn't be written.
+    bool store(const cache_key &key, std::string_view payload) const;
+
+    // Removes every entry, returning how many there were
+    std::size_t clear() const;
+};
@@ -0,0 +1,35 @@
+#include <catch2/catch.hpp>
+
+#include "bit_matrix.h"
+
+TEST_CASE("bit_matrix", "[util][bit_matrix]") {
+    SECTION("cells start clear and can be set and cleared") {
+        bit_matrix m{3, 70};
+        REQUIRE(m.rows() == 3);
+        REQUIRE(m.cols() == 70);
+        // 70 columns need two words a row
+        CHECK(m.word_count() == 6);
+
+        m.set(0, 0);
+        m.set(1, 63);
+        m.set(1, 64);
+        m.set(2, 69);
+        for (bit_matrix::size_type r = 0; r < m.rows(); r++)
+            for (bit_matrix::size_type c = 0; c < m.cols(); c++)
+                CHECK(m(r, c) == ((r == 0 && c == 0) || (r == 1 && (c == 63 || c == 64)) || (r == 2 && c == 69)));
+
+        m.set(1, 63, false);
+        CHECK(!m(1, 63));
+        CHECK(m(1, 64));
+    }
+
+    SECTION("built from rows of characters") {
+        const bit_matrix m{{"#..", ".#.", "..#"}, '#'};
+        bit_matrix expected{3, 3};
+        for (bit_matrix::size_type i = 0; i < 3; i++)
+            expected.set(i, i);
+        CHECK(m == expected);
+        CHECK(m != bit_matrix{3, 3});
+        CHECK(m != bit_matrix{{"#..", ".#.", "..#", "..."}, '#'});
+    }
+}
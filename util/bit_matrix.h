@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+#pragma once
+
+// A matrix of bits packed 64 to a word, for grids whose cells are only ever one thing or another (e.g. wall or floor),
+// at an eighth of the size of a matrix of chars. Every row starts on a word of its own. The words live in
+// current_arena() unless told otherwise.
+class bit_matrix {
+public:
+    using size_type = std::size_t;
+    using word_type = std::uint64_t;
+    static constexpr size_type word_bits = 64;
+
+private:
+    size_type r = 0, c = 0, stride = 0;
+    std::pmr::vector<word_type> words;
+
+public:
+    bit_matrix(size_type rows, size_type cols, std::pmr::memory_resource *resource = current_arena())
+        : r{rows}, c{cols}, stride{(cols + word_bits - 1) / word_bits}, words(rows * stride, 0, resource) {}
+    // One row per string, each the same length, with a cell set wherever the string has the character set. Mostly for
+    // writing test grids out legibly.
+    bit_matrix(std::initializer_list<std::string_view> rows, char set,
+               std::pmr::memory_resource *resource = current_arena())
+        : bit_matrix{rows.size(), rows.size() ? std::begin(rows)->size() : 0, resource} {
+        size_type i = 0;
+        for (const auto row : rows) {
+            for (size_type j = 0; j < row.size() && j < c; j++)
+                if (row[j] == set)
+                    this->set(i, j);
+            i++;
+        }
+    }
+
+    bool operator()(size_type row, size_type col) const {
+        return (words[row * stride + col / word_bits] >> (col % word_bits)) & 1;
+    }
+
+    void set(size_type row, size_type col, bool value = true) {
+        auto &word = words[row * stride + col / word_bits];
+        const auto bit = word_type{1} << (col % word_bits);
+        word = value ? word | bit : word & ~bit;
+    }
+
+    size_type rows() const {
+        return r;
+    }
+
+    size_type cols() const {
+        return c;
+    }
+
+    // The packed words, row by row, for copying in and out in bulk
+    word_type *data() {
+        return words.data();
+    }
+
+    const word_type *data() const {
+        return words.data();
+    }
+
+    size_type word_count() const {
+        return words.size();
+    }
+
+    bool operator==(const bit_matrix &other) const {
+        return r == other.r && c == other.c && words == other.words;
+    }
+
+    bool operator!=(const bit_matrix &other) const {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#endif
+
+#include "cpu_dispatch.h"
+
+namespace {
+
+constexpr const char *level_names[simd_level_count] = {"scalar", "sse2", "sse4.2", "avx2", "avx512"};
+
+} // namespace
+
+simd_level detected_simd_level() {
+#if defined(__x86_64__) || defined(__i386__)
+    // These read cpuid, and for the AVX levels also check with xgetbv that the OS saves the wider registers
+    static const auto level = [] {
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return simd_level::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return simd_level::AVX2;
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+            return simd_level::SSE42;
+        if (__builtin_cpu_supports("sse2"))
+            return simd_level::SSE2;
+        return simd_level::Scalar;
+    }();
+    return level;
+#else
+    return simd_level::Scalar;
+#endif
+}
+
+simd_level best_simd_level() {
+    static const auto level = [] {
+        auto best = detected_simd_level();
+        simd_level forced;
+        if (const auto *const name = std::getenv("AOC_CPU_LEVEL"); name && parse_simd_level(name, forced))
+            best = std::min(best, forced);
+        return best;
+    }();
+    return level;
+}
+
+const char *simd_level_name(simd_level level) {
+    return level_names[static_cast<std::size_t>(level)];
+}
+
+bool parse_simd_level(std::string_view name, simd_level &level) {
+    for (std::size_t i = 0; i < simd_level_count; i++) {
+        if (name == level_names[i]) {
+            level = static_cast<simd_level>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef TESTING
+namespace {
+
+int scalar_variant() {
+    return 0;
+}
+
+int sse2_variant() {
+    return 1;
+}
+
+int avx2_variant() {
+    return 3;
+}
+
+} // namespace
+
+TEST_CASE("simd levels", "[util][cpu_dispatch]") {
+    CHECK(best_simd_level() <= detected_simd_level());
+
+    for (std::size_t i = 0; i < simd_level_count; i++) {
+        const auto level = static_cast<simd_level>(i);
+        simd_level parsed;
+        REQUIRE(parse_simd_level(simd_level_name(level), parsed));
+        CHECK(parsed == level);
+    }
+    simd_level unchanged = simd_level::AVX2;
+    CHECK(!parse_simd_level("avx", unchanged));
+    CHECK(!parse_simd_level("", unchanged));
+    CHECK(unchanged == simd_level::AVX2);
+}
+
+TEST_CASE("simd_kernel", "[util][cpu_dispatch]") {
+    const simd_kernel<int()> kernel{
+        {simd_level::Scalar, scalar_variant}, {simd_level::SSE2, sse2_variant}, {simd_level::AVX2, avx2_variant}};
+
+    SECTION("levels without a variant of their own fall back to the next one down") {
+        CHECK(kernel.variant(simd_level::Scalar)() == 0);
+        CHECK(kernel.variant(simd_level::SSE2)() == 1);
+        CHECK(kernel.variant(simd_level::SSE42)() == 1);
+        CHECK(kernel.variant(simd_level::AVX2)() == 3);
+        CHECK(kernel.variant(simd_level::AVX512)() == 3);
+    }
+
+    SECTION("calling it calls the variant for best_simd_level()") {
+        CHECK(kernel() == kernel.variant(best_simd_level())());
+    }
+
+    SECTION("a kernel with only a scalar variant always uses it") {
+        const simd_kernel<int()> scalar{{simd_level::Scalar, scalar_variant}};
+        CHECK(scalar.variant(simd_level::AVX512)() == 0);
+        CHECK(scalar() == 0);
+    }
+}
+#endif
@@ -0,0 +1,74 @@
+#include <cstddef>
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+
+#pragma once
+
+// Runtime selection between variants of vectorised kernels. The program is built for the baseline of its architecture
+// (no -march), so a kernel that wants newer vector instructions is compiled once per instruction set, each variant
+// with __attribute__((target(...))), and a simd_kernel picks the best of them that the CPU it is running on supports.
+// Setting AOC_CPU_LEVEL in the environment to the name of a level caps it, so that every variant can be exercised
+// (and compared) on one machine.
+
+// Levels of vector instructions, each a superset of the ones before it. Anything better than Scalar is only available
+// on x86, and AVX512 means the byte and word instructions (AVX-512BW) as well as the foundation.
+enum class simd_level {
+    Scalar,
+    SSE2,
+    SSE42,
+    AVX2,
+    AVX512,
+};
+
+constexpr std::size_t simd_level_count = 5;
+
+// The best level the CPU supports, as cpuid (and the OS, for saving the wider registers) reports it, worked out once
+simd_level detected_simd_level();
+
+// The level kernels run at: detected_simd_level(), or AOC_CPU_LEVEL if that is set to a lower one. A level the CPU
+// can't run is never chosen whatever the variable says, and a variable that isn't the name of a level is ignored (the
+// driver refuses to start with one, see parse_simd_level()).
+simd_level best_simd_level();
+
+// What AOC_CPU_LEVEL calls each level: scalar, sse2, sse4.2, avx2 or avx512
+const char *simd_level_name(simd_level level);
+
+// Sets level to the one called name. Returns false if there is no such level.
+bool parse_simd_level(std::string_view name, simd_level &level);
+
+template <class Signature>
+class simd_kernel;
+
+// A kernel with a variant for each of some levels, bound to the best one for best_simd_level() when it is constructed
+// so that calling it is one indirect call. Every kernel has a Scalar variant, which stands in on other architectures
+// and for any level below the lowest vector one.
+template <class R, class... Args>
+class simd_kernel<R(Args...)> {
+public:
+    using function = R (*)(Args...);
+
+private:
+    function variants[simd_level_count] = {};
+    function bound;
+
+public:
+    explicit simd_kernel(std::initializer_list<std::pair<simd_level, function>> vs) {
+        for (const auto &[level, f] : vs)
+            variants[static_cast<std::size_t>(level)] = f;
+        bound = variant(best_simd_level());
+    }
+
+    // The variant for a CPU that supports level: the one for level itself if there is one, or else the best one for a
+    // lower level. Callers asking for a level above detected_simd_level() get code the CPU may not be able to run.
+    function variant(simd_level level) const {
+        for (auto i = static_cast<std::size_t>(level); i > 0; i--)
+            if (variants[i])
+                return variants[i];
+        return variants[0];
+    }
+
+    R operator()(Args... args) const {
+        return bound(std::forward<Args>(args)...);
+    }
+};
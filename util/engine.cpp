@@ -0,0 +1,156 @@
+#include <atomic>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <vector>
+#endif
+
+#include "engine.h"
+
+namespace {
+
+constexpr const char *engine_names[engine_count] = {"reference", "serial", "parallel"};
+
+// engine_count for auto
+std::atomic<std::size_t> selected{engine_count};
+std::atomic<bool> cross_check{false};
+
+} // namespace
+
+std::optional<engine> selected_engine() {
+    const auto e = selected.load();
+    if (e == engine_count)
+        return std::nullopt;
+    return static_cast<engine>(e);
+}
+
+void select_engine(std::optional<engine> e) {
+    selected = e ? static_cast<std::size_t>(*e) : engine_count;
+}
+
+bool cross_checking() {
+    return cross_check;
+}
+
+void set_cross_checking(bool on) {
+    cross_check = on;
+}
+
+const char *engine_name(engine e) {
+    return engine_names[static_cast<std::size_t>(e)];
+}
+
+const char *engine_name(std::optional<engine> e) {
+    return e ? engine_name(*e) : "auto";
+}
+
+bool parse_engine(std::string_view name, std::optional<engine> &e) {
+    if (name == "auto") {
+        e = std::nullopt;
+        return true;
+    }
+    for (std::size_t i = 0; i < engine_count; i++) {
+        if (name == engine_names[i]) {
+            e = static_cast<engine>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef TESTING
+namespace {
+
+using numbers = std::vector<int>;
+
+std::size_t count(const numbers &ns) {
+    return ns.size();
+}
+
+int reference_sum(const numbers &ns) {
+    int sum = 0;
+    for (const auto n : ns)
+        sum += n;
+    return sum;
+}
+
+int serial_sum(const numbers &ns) {
+    return reference_sum(ns) + 1000; // Wrong on purpose, so that it can be told apart
+}
+
+int parallel_sum(const numbers &ns) {
+    return reference_sum(ns) + 2000;
+}
+
+// Puts the process-wide settings back however a test ends
+struct engine_settings_guard {
+    ~engine_settings_guard() {
+        select_engine(std::nullopt);
+        set_cross_checking(false);
+        thread_pool::set_default_size(0);
+    }
+};
+
+} // namespace
+
+TEST_CASE("engine names", "[util][engine]") {
+    for (std::size_t i = 0; i < engine_count; i++) {
+        const auto e = static_cast<engine>(i);
+        std::optional<engine> parsed;
+        REQUIRE(parse_engine(engine_name(e), parsed));
+        CHECK(parsed == e);
+    }
+    std::optional<engine> e = engine::Serial;
+    REQUIRE(parse_engine("auto", e));
+    CHECK(!e);
+    CHECK(std::string{engine_name(e)} == "auto");
+    e = engine::Serial;
+    CHECK(!parse_engine("fast", e));
+    CHECK(e == engine::Serial);
+}
+
+TEST_CASE("engine_set", "[util][engine]") {
+    const engine_settings_guard guard;
+    const engine_set<numbers, int> sum{
+        "sum", "numbers", count, {{engine::Reference, reference_sum}, {engine::Parallel, parallel_sum, 4}}};
+    const numbers few{1, 2, 3}, many{1, 2, 3, 4, 5};
+
+    SECTION("engines a set doesn't have fall back to the next one down") {
+        CHECK(sum.has(engine::Parallel));
+        CHECK(!sum.has(engine::Serial));
+        CHECK(sum.resolve(engine::Serial) == engine::Reference);
+        CHECK(sum.variant(engine::Serial)(few) == 6);
+        CHECK(sum.variant(engine::Parallel)(few) == 2006);
+    }
+
+    SECTION("auto picks by size, and only goes parallel with more than one thread") {
+        thread_pool::set_default_size(4);
+        CHECK(sum.pick(few) == engine::Reference);
+        CHECK(sum.pick(many) == engine::Parallel);
+        CHECK(sum(many) == 2015);
+        thread_pool::set_default_size(1);
+        CHECK(sum.pick(many) == engine::Reference);
+    }
+
+    SECTION("a selected engine is used whatever the size") {
+        select_engine(engine::Parallel);
+        CHECK(sum(few) == 2006);
+        select_engine(engine::Reference);
+        CHECK(sum(many) == 15);
+    }
+
+    SECTION("cross-checking catches answers that differ from the reference") {
+        const engine_set<numbers, int> agreeing{
+            "agreeing", "numbers", count, {{engine::Reference, reference_sum}, {engine::Serial, reference_sum}}};
+        const engine_set<numbers, int> disagreeing{
+            "disagreeing", "numbers", count, {{engine::Reference, reference_sum}, {engine::Serial, serial_sum}}};
+        set_cross_checking(true);
+        select_engine(engine::Serial);
+        CHECK(agreeing(few) == 6);
+        CHECK_THROWS_WITH(disagreeing(few),
+                          "disagreeing: the serial engine's answer 1006 doesn't match the reference engine's 6");
+        select_engine(engine::Reference);
+        CHECK(disagreeing(few) == 6);
+    }
+}
+#endif
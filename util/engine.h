@@ -0,0 +1,144 @@
+#include <cstddef>
+#include <initializer_list>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "thread_pool.h"
+
+#pragma once
+
+// Interchangeable implementations of a day's part, so that a faster but more involved one can sit next to the simple
+// one it replaces. Every part has a reference engine, the straightforward implementation that the others are checked
+// against; some also have a serial engine that is optimised but runs on one thread, and a parallel one that shares the
+// work out over thread_pool::shared().
+//
+// Which engine runs is a setting for the whole process (--engine in the driver): one in particular, or auto, which
+// picks from the size of the input. With cross-checking on, every answer that isn't the reference engine's is worked
+// out again by the reference engine and a mismatch is an error.
+enum class engine {
+    Reference,
+    Serial,
+    Parallel,
+};
+
+constexpr std::size_t engine_count = 3;
+
+// The engine parts run with, or nothing for auto, which is the default
+std::optional<engine> selected_engine();
+void select_engine(std::optional<engine> e);
+
+bool cross_checking();
+void set_cross_checking(bool on);
+
+// What --engine calls each engine: reference, serial or parallel
+const char *engine_name(engine e);
+
+// engine_name(), or auto for nothing
+const char *engine_name(std::optional<engine> e);
+
+// Sets e to the engine called name, or to nothing if name is auto. Returns false if there is no such engine.
+bool parse_engine(std::string_view name, std::optional<engine> &e);
+
+// One part's engines, each a function of the parsed input. An engine a part doesn't have is stood in for by the best
+// one below it, so asking for the parallel engine of a part with only a reference one runs that.
+//
+// Auto picks the best engine, other than the reference, whose threshold the input's size (as measured by size, in
+// units of unit) reaches, and never the parallel one when parallel loops would only get one thread. If there is no such
+// engine it picks the reference one. The thresholds are worked out from timings by the driver's --tune.
+template <class Input, class Output>
+class engine_set {
+public:
+    using function = Output (*)(const Input &);
+    using measure = std::size_t (*)(const Input &);
+
+    struct variant_entry {
+        engine e;
+        function f;
+        std::size_t threshold = 0;
+    };
+
+private:
+    const char *set_name;
+    const char *set_unit;
+    measure measure_size;
+    function variants[engine_count] = {};
+    std::size_t thresholds[engine_count] = {};
+
+public:
+    // name says which part this is in error messages, e.g. "day 7 part 2"
+    engine_set(const char *name, const char *unit, measure size, std::initializer_list<variant_entry> vs)
+        : set_name{name}, set_unit{unit}, measure_size{size} {
+        for (const auto &v : vs) {
+            variants[static_cast<std::size_t>(v.e)] = v.f;
+            thresholds[static_cast<std::size_t>(v.e)] = v.threshold;
+        }
+    }
+
+    const char *name() const {
+        return set_name;
+    }
+
+    const char *unit() const {
+        return set_unit;
+    }
+
+    std::size_t size(const Input &input) const {
+        return measure_size(input);
+    }
+
+    // Whether e is one of this part's own engines, rather than another one standing in for it
+    bool has(engine e) const {
+        return variants[static_cast<std::size_t>(e)] != nullptr;
+    }
+
+    std::size_t threshold(engine e) const {
+        return thresholds[static_cast<std::size_t>(e)];
+    }
+
+    // The engine that runs when e is asked for
+    engine resolve(engine e) const {
+        for (auto i = static_cast<std::size_t>(e); i > 0; i--)
+            if (variants[i])
+                return static_cast<engine>(i);
+        return engine::Reference;
+    }
+
+    function variant(engine e) const {
+        return variants[static_cast<std::size_t>(resolve(e))];
+    }
+
+    // The engine auto picks for input
+    engine pick(const Input &input) const {
+        const auto n = size(input);
+        for (auto i = engine_count - 1; i > 0; i--) {
+            const auto e = static_cast<engine>(i);
+            if (variants[i] && n >= thresholds[i] && (e != engine::Parallel || thread_pool::default_size() > 1))
+                return e;
+        }
+        return engine::Reference;
+    }
+
+    // The engine that runs for input with the engine selected for the process
+    engine choose(const Input &input) const {
+        const auto selected = selected_engine();
+        return selected ? resolve(*selected) : pick(input);
+    }
+
+    Output operator()(const Input &input) const {
+        const auto e = choose(input);
+        auto answer = variant(e)(input);
+        if (e != engine::Reference && cross_checking()) {
+            const auto expected = variant(engine::Reference)(input);
+            if (!(answer == expected)) {
+                std::ostringstream message;
+                message << set_name << ": the " << engine_name(e) << " engine's answer " << answer
+                        << " doesn't match the reference engine's " << expected;
+                throw std::runtime_error{message.str()};
+            }
+        }
+        return answer;
+    }
+};
@@ -0,0 +1,41 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include "footprint.h"
+
+TEST_CASE("footprint", "[util][footprint]") {
+    SECTION("scalars") {
+        CHECK(footprint(std::uint32_t{7}) == 4);
+        CHECK(footprint('c') == 1);
+    }
+
+    SECTION("vectors count their spare capacity") {
+        std::vector<std::uint64_t> v;
+        v.reserve(10);
+        v.push_back(1);
+        CHECK(footprint(v) == sizeof v + 10 * sizeof(std::uint64_t));
+    }
+
+    SECTION("nested containers") {
+        const std::vector<std::vector<std::uint32_t>> v{{1, 2}, {3}};
+        CHECK(footprint(v) > sizeof v + 3 * sizeof(std::uint32_t));
+    }
+
+    SECTION("trees pay for their nodes") {
+        const std::set<std::uint32_t> s{1, 2, 3};
+        CHECK(footprint(s) == sizeof s + 3 * (tree_node_overhead + sizeof(std::uint32_t)));
+    }
+
+    SECTION("matrices") {
+        const dynamic_matrix<char> m{3, 4};
+        CHECK(footprint(m) == sizeof m + 12);
+        CHECK(footprint(bit_matrix{3, 4}) == sizeof(bit_matrix) + 3 * sizeof(bit_matrix::word_type));
+    }
+
+    SECTION("variants count only what they hold") {
+        const std::variant<std::uint8_t, std::vector<std::uint32_t>> v{std::vector<std::uint32_t>{}};
+        CHECK(footprint(v) == sizeof v);
+    }
+}
@@ -0,0 +1,126 @@
+#include <array>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "bit_matrix.h"
+#include "jagged_array.h"
+#include "matrix.h"
+
+#pragma once
+
+// Rough estimates of how many bytes of memory a value occupies, including whatever it owns on the heap. They are meant
+// for budgeting (e.g. how much a cache holds), not accounting, so allocator overheads are guessed at.
+//
+// Structs need an overload of their own in their own namespace, found by argument-dependent lookup.
+
+// libstdc++'s red-black tree nodes carry a colour and three pointers before the value, and malloc rounds up too
+constexpr std::size_t tree_node_overhead = 48;
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, std::size_t> footprint(const T &);
+// Doesn't count what it points at, which the view's owner has to account for
+inline std::size_t footprint(std::string_view);
+template <class T, class U>
+std::size_t footprint(const std::pair<T, U> &p);
+template <class T, std::size_t N>
+std::size_t footprint(const std::array<T, N> &a);
+template <class T, class A>
+std::size_t footprint(const std::vector<T, A> &v);
+template <class T, class C, class A>
+std::size_t footprint(const std::set<T, C, A> &s);
+template <class K, class V, class C, class A>
+std::size_t footprint(const std::map<K, V, C, A> &m);
+template <class K, class V, class C, class A>
+std::size_t footprint(const std::multimap<K, V, C, A> &m);
+template <class T, class A>
+std::size_t footprint(const dynamic_matrix<T, A> &m);
+template <class T>
+std::size_t footprint(const jagged_array<T> &a);
+inline std::size_t footprint(const bit_matrix &m);
+template <class... Ts>
+std::size_t footprint(const std::variant<Ts...> &v);
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, std::size_t> footprint(const T &) {
+    return sizeof(T);
+}
+
+inline std::size_t footprint(std::string_view) {
+    return sizeof(std::string_view);
+}
+
+template <class T, class U>
+std::size_t footprint(const std::pair<T, U> &p) {
+    return footprint(p.first) + footprint(p.second);
+}
+
+template <class T, std::size_t N>
+std::size_t footprint(const std::array<T, N> &a) {
+    std::size_t n = 0;
+    for (const auto &x : a)
+        n += footprint(x);
+    return n;
+}
+
+template <class T, class A>
+std::size_t footprint(const std::vector<T, A> &v) {
+    auto n = sizeof v + (v.capacity() - v.size()) * sizeof(T);
+    for (const auto &x : v)
+        n += footprint(x);
+    return n;
+}
+
+template <class Container>
+std::size_t tree_footprint(const Container &c) {
+    auto n = sizeof c;
+    for (const auto &x : c)
+        n += tree_node_overhead + footprint(x);
+    return n;
+}
+
+template <class T, class C, class A>
+std::size_t footprint(const std::set<T, C, A> &s) {
+    return tree_footprint(s);
+}
+
+template <class K, class V, class C, class A>
+std::size_t footprint(const std::map<K, V, C, A> &m) {
+    return tree_footprint(m);
+}
+
+template <class K, class V, class C, class A>
+std::size_t footprint(const std::multimap<K, V, C, A> &m) {
+    return tree_footprint(m);
+}
+
+template <class T, class A>
+std::size_t footprint(const dynamic_matrix<T, A> &m) {
+    std::size_t n = sizeof m;
+    for (const auto &x : m)
+        n += footprint(x);
+    return n;
+}
+
+template <class T>
+std::size_t footprint(const jagged_array<T> &a) {
+    return footprint(a.values()) + footprint(a.offsets());
+}
+
+inline std::size_t footprint(const bit_matrix &m) {
+    return sizeof m + m.word_count() * sizeof(bit_matrix::word_type);
+}
+
+template <class... Ts>
+std::size_t footprint(const std::variant<Ts...> &v) {
+    return std::visit(
+        [](const auto &x) {
+            return sizeof v - sizeof x + footprint(x);
+        },
+        v);
+}
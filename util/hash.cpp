@@ -0,0 +1,29 @@
+#include <catch2/catch.hpp>
+#include <set>
+#include <string>
+
+#include "hash.h"
+
+TEST_CASE("hash_bytes", "[util][hash]") {
+    SECTION("deterministic") {
+        CHECK(hash_bytes("mul(2,4)") == hash_bytes(std::string{"mul(2,4)"}));
+        CHECK(hash_bytes("") == hash_bytes(""));
+    }
+
+    SECTION("seed changes the result") {
+        CHECK(hash_bytes("mul(2,4)", 1) != hash_bytes("mul(2,4)", 2));
+    }
+
+    SECTION("every length and every single-byte change gives a different hash") {
+        // Covers the 32-byte lanes, the 8-byte words and the tail
+        std::string s(100, 'x');
+        std::set<std::uint64_t> seen;
+        for (std::size_t len = 0; len <= s.size(); len++)
+            CHECK(seen.insert(hash_bytes(s.data(), len)).second);
+        for (std::size_t i = 0; i < s.size(); i++) {
+            auto t = s;
+            t[i] = 'y';
+            CHECK(seen.insert(hash_bytes(t)).second);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#pragma once
+
+// A fast, non-cryptographic 64-bit hash for telling puzzle inputs apart. It consumes eight bytes at a time across four
+// independent lanes, so large inputs hash at close to memory bandwidth, and finishes with the MurmurHash3 finalizer.
+// Not suitable for anything adversarial.
+namespace hash_detail {
+
+constexpr std::uint64_t prime1 = 0x9e3779b185ebca87ULL, prime2 = 0xc2b2ae3d27d4eb4fULL;
+
+inline std::uint64_t rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline std::uint64_t round(std::uint64_t lane, std::uint64_t word) {
+    return rotl(lane + word * prime2, 31) * prime1;
+}
+
+inline std::uint64_t fmix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline std::uint64_t load(const unsigned char *p) {
+    std::uint64_t w;
+    std::memcpy(&w, p, sizeof w);
+    return w;
+}
+
+} // namespace hash_detail
+
+inline std::uint64_t hash_bytes(const void *data, std::size_t len, std::uint64_t seed = 0) {
+    using namespace hash_detail;
+    const auto *p = static_cast<const unsigned char *>(data);
+    const auto *const end = p + len;
+
+    std::uint64_t a = seed + prime1 + prime2, b = seed + prime2, c = seed, d = seed - prime1;
+    for (; end - p >= 32; p += 32) {
+        a = round(a, load(p));
+        b = round(b, load(p + 8));
+        c = round(c, load(p + 16));
+        d = round(d, load(p + 24));
+    }
+
+    auto h = rotl(a, 1) + rotl(b, 7) + rotl(c, 12) + rotl(d, 18) + len;
+    for (; end - p >= 8; p += 8)
+        h = round(h, load(p));
+    if (p != end) {
+        unsigned char tail[8] = {};
+        std::memcpy(tail, p, end - p);
+        h = round(h, load(tail));
+    }
+
+    return fmix(h);
+}
+
+inline std::uint64_t hash_bytes(std::string_view s, std::uint64_t seed = 0) {
+    return hash_bytes(s.data(), s.size(), seed);
+}
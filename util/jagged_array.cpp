@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "jagged_array.h"
+
+TEST_CASE("jagged_array", "[util][jagged_array]") {
+    SECTION("building rows while parsing") {
+        jagged_array<std::uint32_t> a;
+        CHECK(a.empty());
+        a.push_back(1);
+        a.push_back(2);
+        a.end_row();
+        a.end_row();
+        a.push_back(3);
+        a.end_row();
+
+        REQUIRE(a.size() == 3);
+        CHECK(a[0] == jagged_array<std::uint32_t>::row{1, 2});
+        CHECK(a[1].empty());
+        CHECK(a[2].front() == 3);
+        CHECK(a == jagged_array<std::uint32_t>{{1, 2}, {}, {3}});
+        CHECK(a != jagged_array<std::uint32_t>{{1}, {2}, {3}});
+    }
+
+    SECTION("iterating over rows") {
+        const jagged_array<int> a{{1, 2, 3}, {4}, {5, 6}};
+        std::vector<std::vector<int>> rows;
+        for (const auto row : a)
+            rows.emplace_back(std::begin(row), std::end(row));
+        CHECK(rows == std::vector<std::vector<int>>{{1, 2, 3}, {4}, {5, 6}});
+    }
+
+    SECTION("rows can view other containers") {
+        const std::vector<int> v{1, 2};
+        const jagged_array<int> a{{1, 2}};
+        CHECK(a[0] == v);
+    }
+
+    SECTION("moving out of an array leaves it empty and usable") {
+        jagged_array<int> a{{1, 2, 3}, {4}};
+        auto b = std::move(a);
+        CHECK(b == jagged_array<int>{{1, 2, 3}, {4}});
+        CHECK(a.empty());
+        CHECK(a.size() == 0);
+        CHECK(a.begin() == a.end());
+        a.push_back(5);
+        a.end_row();
+        CHECK(a == jagged_array<int>{{5}});
+
+        b = std::move(a);
+        CHECK(b == jagged_array<int>{{5}});
+        CHECK(a.empty());
+        CHECK(a.offsets() == std::vector<std::size_t>{0});
+    }
+
+    SECTION("from_parts") {
+        const jagged_array<int> a{{1, 2, 3}, {4}};
+        auto values = a.values();
+        auto offsets = a.offsets();
+        CHECK(jagged_array<int>::from_parts(values, offsets) == a);
+        offsets.back()++;
+        CHECK_THROWS_AS(jagged_array<int>::from_parts(values, offsets), std::invalid_argument);
+    }
+}
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#pragma once
+
+// A list of variable-length rows of values stored back to back in one buffer, with a second buffer of where each row
+// starts, in place of a vector of vectors. Building one costs two growing allocations however many rows there are,
+// rather than one per row, and walking the rows in order walks memory in order.
+//
+// Rows are appended one value at a time while parsing: push_back() values onto the row being built then end_row().
+// Rows are read through row views, which stay valid until the array is next modified. Arrays are move-only, since
+// copying one by accident would copy everything.
+template <class T>
+class jagged_array {
+public:
+    using size_type = std::size_t;
+
+    // A read-only view of one row's values. It can also view a std::vector or a braced list of values, so that
+    // functions taking a row can be called on those too; the view is only good for as long as what it views.
+    class row {
+    public:
+        using value_type = T;
+        using size_type = jagged_array::size_type;
+        using const_iterator = const T *;
+        using iterator = const_iterator;
+
+    private:
+        const T *first = nullptr;
+        size_type n = 0;
+
+    public:
+        row() = default;
+        row(const T *data, size_type size) : first{data}, n{size} {}
+        row(const std::vector<T> &v) : first{v.data()}, n{v.size()} {}
+        row(std::initializer_list<T> il) : first{il.begin()}, n{il.size()} {}
+
+        const T *data() const {
+            return first;
+        }
+
+        size_type size() const {
+            return n;
+        }
+
+        bool empty() const {
+            return n == 0;
+        }
+
+        const T &operator[](size_type i) const {
+            return first[i];
+        }
+
+        const T &front() const {
+            return first[0];
+        }
+
+        const T &back() const {
+            return first[n - 1];
+        }
+
+        const_iterator begin() const {
+            return first;
+        }
+
+        const_iterator end() const {
+            return first + n;
+        }
+
+        bool operator==(const row &other) const {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+        bool operator!=(const row &other) const {
+            return !(*this == other);
+        }
+    };
+
+    class const_iterator {
+        const jagged_array *a;
+        size_type i;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = row;
+
+        const_iterator(const jagged_array *a, size_type i) : a{a}, i{i} {}
+
+        row operator*() const {
+            return (*a)[i];
+        }
+
+        const_iterator &operator++() {
+            i++;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto old = *this;
+            i++;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return i == other.i;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return i != other.i;
+        }
+    };
+
+    using value_type = row;
+    using iterator = const_iterator;
+
+    jagged_array() = default;
+    jagged_array(std::initializer_list<std::initializer_list<T>> ilist) {
+        size_type total = 0;
+        for (const auto &r : ilist)
+            total += r.size();
+        reserve(ilist.size(), total);
+        for (const auto &r : ilist)
+            push_row(std::begin(r), std::end(r));
+    }
+    jagged_array(const jagged_array &other) = delete;
+    // Leaves other empty, with the offset of its first row still in place, rather than without any offsets at all
+    jagged_array(jagged_array &&other) : vals{std::move(other.vals)}, offs{std::move(other.offs)} {
+        other.clear();
+    }
+
+    jagged_array &operator=(const jagged_array &other) = delete;
+    jagged_array &operator=(jagged_array &&other) {
+        if (this != &other) {
+            vals = std::move(other.vals);
+            offs = std::move(other.offs);
+            other.clear();
+        }
+        return *this;
+    }
+
+    // Rebuilds an array from the buffers returned by values() and offsets(), throwing std::invalid_argument if they
+    // don't describe one
+    static jagged_array from_parts(std::vector<T> values, std::vector<size_type> offsets) {
+        if (offsets.empty() || offsets.front() != 0 || offsets.back() != values.size() ||
+            !std::is_sorted(std::begin(offsets), std::end(offsets)))
+            throw std::invalid_argument{"offsets don't describe a jagged_array"};
+        jagged_array a;
+        a.vals = std::move(values);
+        a.offs = std::move(offsets);
+        return a;
+    }
+
+    // Removes every row, and the one being built
+    void clear() {
+        vals.clear();
+        offs.assign(1, 0);
+    }
+
+    void reserve(size_type rows, size_type values) {
+        offs.reserve(rows + 1);
+        vals.reserve(values);
+    }
+
+    // Appends x to the row being built
+    void push_back(const T &x) {
+        vals.push_back(x);
+    }
+
+    // Finishes the row being built, which may be empty
+    void end_row() {
+        offs.push_back(vals.size());
+    }
+
+    template <class It>
+    void push_row(It first, It last) {
+        vals.insert(std::end(vals), first, last);
+        end_row();
+    }
+
+    // The number of finished rows
+    size_type size() const {
+        return offs.size() - 1;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    row operator[](size_type i) const {
+        return row{vals.data() + offs[i], offs[i + 1] - offs[i]};
+    }
+
+    const_iterator begin() const {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const {
+        return const_iterator{this, size()};
+    }
+
+    // Every value in every finished row (and the one being built), in order
+    const std::vector<T> &values() const {
+        return vals;
+    }
+
+    // Where each row starts in values(), followed by where the next row would
+    const std::vector<size_type> &offsets() const {
+        return offs;
+    }
+
+    bool operator==(const jagged_array &other) const {
+        return vals == other.vals && offs == other.offs;
+    }
+
+    bool operator!=(const jagged_array &other) const {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<T> vals;
+    std::vector<size_type> offs{0};
+};
@@ -0,0 +1,174 @@
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LINE_INDEX_X86
+#endif
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <string>
+
+#include "mapped_file.h"
+#endif
+
+#include "line_index.h"
+
+namespace {
+
+void find_scalar(std::string_view text, std::size_t from, std::string_view chars, std::vector<std::size_t> &out) {
+    if (chars.size() == 1) {
+        // memchr is vectorised already, and skips long stretches without a match quickly
+        const auto *const begin = text.data();
+        const auto *const end = begin + text.size();
+        for (auto *p = begin + from; (p = static_cast<const char *>(std::memchr(p, chars[0], end - p))); p++)
+            out.push_back(p - begin);
+        return;
+    }
+
+    for (auto i = from; i < text.size(); i++)
+        if (chars.find(text[i]) != std::string_view::npos)
+            out.push_back(i);
+}
+
+#ifdef LINE_INDEX_X86
+// Turns each set bit of a block's match mask into an offset
+template <class Mask>
+void push_matches(Mask mask, std::size_t base, std::vector<std::size_t> &out) {
+    for (; mask; mask &= mask - 1)
+        out.push_back(base + __builtin_ctz(mask));
+}
+
+__attribute__((target("sse2"))) void find_sse2(std::string_view text, std::string_view chars,
+                                               std::vector<std::size_t> &out) {
+    std::size_t i = 0;
+    for (; i + 16 <= text.size(); i += 16) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+        auto hits = _mm_setzero_si128();
+        for (const auto c : chars)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+        push_matches(static_cast<unsigned>(_mm_movemask_epi8(hits)), i, out);
+    }
+    find_scalar(text, i, chars, out);
+}
+
+__attribute__((target("avx2"))) void find_avx2(std::string_view text, std::string_view chars,
+                                               std::vector<std::size_t> &out) {
+    std::size_t i = 0;
+    for (; i + 32 <= text.size(); i += 32) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + i));
+        auto hits = _mm256_setzero_si256();
+        for (const auto c : chars)
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)));
+        push_matches(static_cast<unsigned>(_mm256_movemask_epi8(hits)), i, out);
+    }
+    find_scalar(text, i, chars, out);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void find_avx512(std::string_view text, std::string_view chars,
+                                                             std::vector<std::size_t> &out) {
+    std::size_t i = 0;
+    for (; i + 64 <= text.size(); i += 64) {
+        const auto block = _mm512_loadu_si512(text.data() + i);
+        __mmask64 hits = 0;
+        for (const auto c : chars)
+            hits |= _mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8(c));
+        for (; hits; hits &= hits - 1)
+            out.push_back(i + __builtin_ctzll(hits));
+    }
+    find_scalar(text, i, chars, out);
+}
+#endif
+
+void find_all_scalar(std::string_view text, std::string_view chars, std::vector<std::size_t> &out) {
+    find_scalar(text, 0, chars, out);
+}
+
+const simd_kernel<void(std::string_view, std::string_view, std::vector<std::size_t> &)> find_kernel{
+    {simd_level::Scalar, find_all_scalar},
+#ifdef LINE_INDEX_X86
+    {simd_level::SSE2, find_sse2},
+    {simd_level::AVX2, find_avx2},
+    {simd_level::AVX512, find_avx512},
+#endif
+};
+
+} // namespace
+
+void find_bytes(std::string_view text, std::string_view chars, std::vector<std::size_t> &out, simd_level level) {
+    find_kernel.variant(level)(text, chars, out);
+}
+
+line_index::line_index(std::string_view text, simd_level level) : text{text} {
+    // A rough guess at the number of lines saves most of the vector's regrowth
+    starts.reserve(text.size() / 16 + 2);
+    starts.push_back(0);
+    const auto first_newline = starts.size();
+    find_bytes(text, "\n", starts, level);
+    // Each newline's offset becomes the start of the line after it
+    for (auto i = first_newline; i < starts.size(); i++)
+        starts[i]++;
+    if (starts.back() != text.size())
+        starts.push_back(text.size());
+}
+
+#ifdef TESTING
+TEST_CASE("find_bytes", "[util][line_index]") {
+    // Long enough to exercise the vector loops (even the 64-byte one) and their scalar tails
+    const std::string text = "3   4\n4   3\n2   5\n1   3\n3   9\n3   3\n12|34,56: 7 8 9\n|,:\n"
+                             "47|53\n97|13\n97|61\n75,29,13\n";
+    const std::vector<simd_level> levels{simd_level::Scalar, simd_level::SSE2, simd_level::AVX2, simd_level::AVX512};
+
+    for (const auto chars : {"\n", " ", ",|:", "x"}) {
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < text.size(); i++)
+            if (std::string_view{chars}.find(text[i]) != std::string_view::npos)
+                expected.push_back(i);
+
+        for (const auto level : levels) {
+            if (level > detected_simd_level())
+                continue;
+            std::vector<std::size_t> found;
+            find_bytes(text, chars, found, level);
+            CHECK(found == expected);
+        }
+    }
+}
+
+TEST_CASE("line_index", "[util][line_index]") {
+    SECTION("edge cases") {
+        CHECK(line_index{""}.size() == 0);
+        CHECK(line_index{"\n"}.size() == 1);
+
+        const line_index no_newline{"ab\n\ncd"};
+        REQUIRE(no_newline.size() == 3);
+        CHECK(no_newline.line(0) == "ab");
+        CHECK(no_newline.line(1) == "");
+        CHECK(no_newline.line(2) == "cd");
+        CHECK(no_newline.lines(1, 3) == "\ncd");
+    }
+
+    SECTION("agrees with splitting every fixture by hand") {
+        for (const auto *path : {"fixtures/day1-input.txt", "fixtures/day2-input.txt", "fixtures/day5-input.txt",
+                                 "fixtures/day7-input.txt", "fixtures/day8-input.txt"}) {
+            const mapped_file input{path};
+            REQUIRE(input);
+
+            std::vector<std::string_view> expected;
+            for (auto rest = input.view(); !rest.empty();) {
+                const auto eol = rest.find('\n');
+                expected.push_back(rest.substr(0, eol));
+                rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
+            }
+
+            for (const auto level : {simd_level::Scalar, best_simd_level()}) {
+                const line_index index{input, level};
+                REQUIRE(index.size() == expected.size());
+                for (std::size_t i = 0; i < expected.size(); i++)
+                    CHECK(index.line(i) == expected[i]);
+                CHECK(index.lines(0, index.size()) == input.view());
+            }
+        }
+    }
+}
+#endif
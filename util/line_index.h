@@ -0,0 +1,43 @@
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "cpu_dispatch.h"
+
+#pragma once
+
+// Appends the offset of every byte in text that is one of chars to out, in order. Searching for several characters
+// at once costs about the same as searching for one.
+void find_bytes(std::string_view text, std::string_view chars, std::vector<std::size_t> &out,
+                simd_level level = best_simd_level());
+
+// Where every line in a buffer of text starts, found in one vectorised pass, so that parsers can reserve space for
+// every line up front and jump straight to any of them, or split the text into ranges of whole lines to hand to
+// different threads. Lines end at '\n', which isn't part of them; a final newline doesn't start another (empty) line.
+// The text must outlive the index.
+class line_index {
+    std::string_view text;
+    // Offset of the start of each line, then one more entry as if for a line starting after the last one's newline
+    std::vector<std::size_t> starts;
+
+public:
+    using size_type = std::size_t;
+
+    explicit line_index(std::string_view text, simd_level level = best_simd_level());
+
+    size_type size() const {
+        return starts.size() - 1;
+    }
+
+    std::string_view line(size_type i) const {
+        const auto begin = starts[i], end = starts[i + 1];
+        // Every line but perhaps the last has a newline to drop
+        const auto len = end - begin - (end > begin && text[end - 1] == '\n');
+        return text.substr(begin, len);
+    }
+
+    // Lines [first, last) with their newlines, as one piece of text
+    std::string_view lines(size_type first, size_type last) const {
+        return text.substr(starts[first], starts[last] - starts[first]);
+    }
+};
@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+#include <string>
+
+#include "lru_cache.h"
+
+TEST_CASE("lru_cache", "[util][lru_cache]") {
+    lru_cache<int, std::string> cache{10};
+
+    SECTION("find after insert") {
+        REQUIRE(cache.insert(1, "one", 3));
+        REQUIRE(cache.find(1));
+        CHECK(*cache.find(1) == "one");
+        CHECK(!cache.find(2));
+        CHECK(cache.size() == 1);
+        CHECK(cache.cost() == 3);
+    }
+
+    SECTION("evicts least recently used first") {
+        cache.insert(1, "one", 4);
+        cache.insert(2, "two", 4);
+        cache.find(1); // 2 is now the least recently used
+        cache.insert(3, "three", 4);
+        CHECK(cache.find(1));
+        CHECK(!cache.find(2));
+        CHECK(cache.find(3));
+        CHECK(cache.cost() == 8);
+    }
+
+    SECTION("evicts as many as it takes") {
+        cache.insert(1, "one", 3);
+        cache.insert(2, "two", 3);
+        cache.insert(3, "three", 3);
+        cache.insert(4, "four", 9);
+        CHECK(cache.size() == 1);
+        CHECK(cache.find(4));
+    }
+
+    SECTION("too big to cache") {
+        cache.insert(1, "one", 3);
+        CHECK(!cache.insert(2, "two", 11));
+        CHECK(!cache.find(2));
+        CHECK(cache.find(1));
+    }
+
+    SECTION("insert replaces") {
+        cache.insert(1, "one", 3);
+        cache.insert(1, "uno", 5);
+        CHECK(*cache.find(1) == "uno");
+        CHECK(cache.size() == 1);
+        CHECK(cache.cost() == 5);
+    }
+
+    SECTION("erase and clear") {
+        cache.insert(1, "one", 3);
+        cache.insert(2, "two", 3);
+        cache.erase(1);
+        CHECK(!cache.find(1));
+        CHECK(cache.cost() == 3);
+        cache.clear();
+        CHECK(cache.size() == 0);
+        CHECK(cache.cost() == 0);
+    }
+}
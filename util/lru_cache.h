@@ -0,0 +1,86 @@
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#pragma once
+
+// A cache that holds values up to a total cost (e.g. a number of bytes) and, when something new doesn't fit, evicts
+// whatever was least recently looked up or inserted until it does. Not thread safe.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class lru_cache {
+    struct entry {
+        Key key;
+        Value value;
+        std::size_t cost;
+    };
+
+    // Most recently used at the front
+    std::list<entry> entries;
+    std::unordered_map<Key, typename std::list<entry>::iterator, Hash> index;
+    std::size_t cap, used = 0;
+
+    void evict_one() {
+        used -= entries.back().cost;
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using size_type = std::size_t;
+
+    explicit lru_cache(size_type capacity) : cap{capacity} {}
+
+    // Returns nullptr if key isn't cached. The pointer is only good until the next insert().
+    Value *find(const Key &key) {
+        const auto it = index.find(key);
+        if (it == std::end(index))
+            return nullptr;
+        entries.splice(std::begin(entries), entries, it->second);
+        return &it->second->value;
+    }
+
+    // Replaces any existing value for key. Something that costs more than the whole capacity isn't cached at all, and
+    // false is returned.
+    bool insert(const Key &key, Value value, size_type cost) {
+        erase(key);
+        if (cost > cap)
+            return false;
+        while (used + cost > cap)
+            evict_one();
+        entries.push_front(entry{key, std::move(value), cost});
+        index.emplace(key, std::begin(entries));
+        used += cost;
+        return true;
+    }
+
+    void erase(const Key &key) {
+        const auto it = index.find(key);
+        if (it == std::end(index))
+            return;
+        used -= it->second->cost;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        used = 0;
+    }
+
+    size_type size() const {
+        return entries.size();
+    }
+
+    size_type cost() const {
+        return used;
+    }
+
+    size_type capacity() const {
+        return cap;
+    }
+};
@@ -0,0 +1,122 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <cstdio>
+#endif
+
+#include "mapped_file.h"
+
+mapped_file::mapped_file(const char *path) {
+    const auto fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return;
+    }
+
+    if (S_ISREG(st.st_mode)) {
+        len = st.st_size;
+        if (len == 0) {
+            // mmap(2) refuses zero-length mappings, but an empty file is still a perfectly good (empty) input
+            addr = "";
+            ok = true;
+            close(fd);
+            return;
+        }
+
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        // Prefault the whole file now rather than taking a page fault every 4 KiB while parsing
+        flags |= MAP_POPULATE;
+#endif
+        auto *p = mmap(nullptr, len, PROT_READ, flags, fd, 0);
+        if (p != MAP_FAILED) {
+            // Every parser makes a single forward pass over its input
+            madvise(p, len, MADV_SEQUENTIAL);
+            madvise(p, len, MADV_WILLNEED);
+            addr = static_cast<const char *>(p);
+            mapped = ok = true;
+            close(fd);
+            return;
+        }
+    }
+
+    // Not something we can map, so fall back to slurping it into memory
+    std::size_t cap = S_ISREG(st.st_mode) && st.st_size > 0 ? st.st_size : 64 * 1024;
+    buf = std::make_unique<char[]>(cap);
+    len = 0;
+    for (;;) {
+        if (len == cap) {
+            auto bigger = std::make_unique<char[]>(cap * 2);
+            std::memcpy(bigger.get(), buf.get(), len);
+            buf = std::move(bigger);
+            cap *= 2;
+        }
+        const auto n = read(fd, buf.get() + len, cap - len);
+        if (n == -1) {
+            close(fd);
+            return;
+        }
+        if (n == 0)
+            break;
+        len += n;
+    }
+
+    close(fd);
+    addr = buf.get();
+    ok = true;
+}
+
+mapped_file::mapped_file(mapped_file &&other)
+    : addr{std::exchange(other.addr, nullptr)}, len{std::exchange(other.len, 0)},
+      mapped{std::exchange(other.mapped, false)}, ok{std::exchange(other.ok, false)}, buf{std::move(other.buf)} {}
+
+mapped_file::~mapped_file() {
+    if (mapped)
+        munmap(const_cast<char *>(addr), len);
+}
+
+#ifdef TESTING
+TEST_CASE("mapped_file", "[util][mapped_file]") {
+    SECTION("maps a fixture") {
+        const mapped_file f{"fixtures/day0-input.txt"};
+        REQUIRE(f);
+        CHECK(f.view() == "0 1 2 3 4 5 6 7 8 9 10\n");
+    }
+
+    SECTION("missing file") {
+        const mapped_file f{"fixtures/does-not-exist.txt"};
+        CHECK(!f);
+    }
+
+    SECTION("empty file") {
+        char path[] = "/tmp/aoc2024-mapped-file-XXXXXX";
+        const auto fd = mkstemp(path);
+        REQUIRE(fd != -1);
+        close(fd);
+
+        const mapped_file f{path};
+        CHECK(f);
+        CHECK(f.view().empty());
+        std::remove(path);
+    }
+
+    SECTION("move constructor") {
+        mapped_file a{"fixtures/day0-input.txt"};
+        const mapped_file b{std::move(a)};
+        CHECK(!a);
+        REQUIRE(b);
+        CHECK(b.size() == 23);
+    }
+}
+#endif
@@ -0,0 +1,48 @@
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#pragma once
+
+// A read-only view of an entire file, backed by mmap(2) where possible. Like std::ifstream, constructing one never
+// throws: test the object in a boolean context to find out whether the file could be opened.
+//
+// Files that cannot be mapped (pipes, character devices, procfs entries) are read into a heap buffer instead so that
+// callers always get a contiguous buffer regardless of where the input comes from.
+class mapped_file {
+    const char *addr = nullptr;
+    std::size_t len = 0;
+    bool mapped = false, ok = false;
+    std::unique_ptr<char[]> buf;
+
+public:
+    using size_type = std::size_t;
+
+    explicit mapped_file(const char *path);
+    mapped_file(const mapped_file &other) = delete;
+    mapped_file(mapped_file &&other);
+    ~mapped_file();
+
+    mapped_file &operator=(const mapped_file &other) = delete;
+    mapped_file &operator=(mapped_file &&other) = delete;
+
+    explicit operator bool() const {
+        return ok;
+    }
+
+    const char *data() const {
+        return addr;
+    }
+
+    size_type size() const {
+        return len;
+    }
+
+    std::string_view view() const {
+        return std::string_view{addr, len};
+    }
+
+    operator std::string_view() const {
+        return view();
+    }
+};
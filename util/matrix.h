@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <initializer_list>
 #include <istream>
+#include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <stdexcept>
 #include <vector>
@@ -232,14 +234,16 @@ public:
     }
 };
 
-template <class T>
+// Allocator is what the elements are allocated with, e.g. a polymorphic allocator to put them in an arena
+template <class T, class Allocator = std::allocator<T>>
 class dynamic_matrix : public basic_matrix<T> {
-    std::vector<T> vec;
+    std::vector<T, Allocator> vec;
     using vec_type = decltype(vec);
     typename vec_type::size_type r, c;
 
 public:
     using value_type = T;
+    using allocator_type = Allocator;
     using size_type = typename vec_type::size_type;
     using reference = value_type &;
     using const_reference = const value_type &;
@@ -250,10 +254,12 @@ public:
     using reverse_iterator = typename vec_type::reverse_iterator;
     using const_reverse_iterator = typename vec_type::const_reverse_iterator;
 
-    dynamic_matrix(size_type r, size_type c, const T &x = T()) : r{r}, c{c}, vec(r * c, x) {}
-    dynamic_matrix(const dynamic_matrix<T> &other) : r{other.r}, c{other.c}, vec{other.vec} {}
-    dynamic_matrix(dynamic_matrix<T> &&other) : r{other.r}, c{other.c}, vec{std::move(other.vec)} {}
-    dynamic_matrix(std::initializer_list<std::initializer_list<value_type>> ilist) : r{ilist.size()} {
+    dynamic_matrix(size_type r, size_type c, const T &x = T(), const Allocator &alloc = Allocator())
+        : r{r}, c{c}, vec(r * c, x, alloc) {}
+    dynamic_matrix(const dynamic_matrix &other) : r{other.r}, c{other.c}, vec{other.vec} {}
+    dynamic_matrix(dynamic_matrix &&other) : r{other.r}, c{other.c}, vec{std::move(other.vec)} {}
+    dynamic_matrix(std::initializer_list<std::initializer_list<value_type>> ilist, const Allocator &alloc = Allocator())
+        : vec(alloc), r{ilist.size()} {
         auto it{std::begin(ilist)};
         c = it->size();
         for (; it != std::end(ilist); it++) {
@@ -287,6 +293,10 @@ public:
         return vec.data();
     }
 
+    allocator_type get_allocator() const {
+        return vec.get_allocator();
+    }
+
     iterator begin() {
         return std::begin(vec);
     }
@@ -343,3 +353,6 @@ public:
         return c;
     }
 };
+
+template <class T>
+using pmr_dynamic_matrix = dynamic_matrix<T, std::pmr::polymorphic_allocator<T>>;
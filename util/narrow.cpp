@@ -0,0 +1,30 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "narrow.h"
+#include "scan.h"
+
+template <class T>
+using numbers = std::vector<T>;
+
+static narrow_variant<numbers> parse_numbers(std::string_view s) {
+    return parse_narrowest<numbers>([s](auto width) {
+        using T = typename decltype(width)::type;
+        numbers<T> v;
+        scanner sc{s};
+        for (T n; sc.next(n);)
+            v.push_back(n);
+        return v;
+    });
+}
+
+TEST_CASE("parse_narrowest", "[util][narrow]") {
+    CHECK(parse_numbers("1 2 255") == narrow_variant<numbers>{numbers<std::uint8_t>{1, 2, 255}});
+    CHECK(parse_numbers("1 256") == narrow_variant<numbers>{numbers<std::uint16_t>{1, 256}});
+    CHECK(parse_numbers("65536 2") == narrow_variant<numbers>{numbers<std::uint32_t>{65536, 2}});
+    CHECK(parse_numbers("") == narrow_variant<numbers>{numbers<std::uint8_t>{}});
+    CHECK_THROWS_AS(parse_numbers("4294967296"), std::out_of_range);
+}
@@ -0,0 +1,36 @@
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+#pragma once
+
+// Storage for puzzle inputs whose numbers are nearly always small. An input type templated on the width of the
+// integers it holds, C<T>, is parsed into the narrowest of C<std::uint8_t>, C<std::uint16_t> and C<std::uint32_t> that
+// fits every number in it, so that a typical input takes a quarter of the memory (and memory bandwidth) it would with
+// 32-bit numbers throughout. Solvers std::visit() the variant and are written once as templates.
+template <template <class> class C>
+using narrow_variant = std::variant<C<std::uint8_t>, C<std::uint16_t>, C<std::uint32_t>>;
+
+// Tells parse_narrowest()'s callback which width to parse into
+template <class T>
+struct narrow_width {
+    using type = T;
+};
+
+// Calls parse(narrow_width<T>{}) for each T narrowest first until one doesn't throw std::out_of_range, which is what
+// scanner throws for a number too big for the type asked for, and returns what it returned. Inputs that need wider
+// numbers are parsed more than once, but it costs nothing extra for the ones that don't, which is nearly all of them.
+// Numbers too big even for 32 bits throw std::out_of_range still.
+template <template <class> class C, class F>
+narrow_variant<C> parse_narrowest(F &&parse) {
+    try {
+        return parse(narrow_width<std::uint8_t>{});
+    } catch (const std::out_of_range &) {
+    }
+    try {
+        return parse(narrow_width<std::uint16_t>{});
+    } catch (const std::out_of_range &) {
+    }
+    return parse(narrow_width<std::uint32_t>{});
+}
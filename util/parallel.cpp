@@ -0,0 +1,176 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+TEST_CASE("parallel_for", "[util][parallel]") {
+    SECTION("every index is visited exactly once, whatever the grain") {
+        thread_pool pool{4};
+        for (const std::size_t grain : {0, 1, 7, 1000, 5000}) {
+            std::vector<std::atomic<int>> visits(1000);
+            parallel_for(
+                0, visits.size(), grain,
+                [&visits](std::size_t begin, std::size_t end) {
+                    for (auto i = begin; i < end; i++)
+                        visits[i]++;
+                },
+                pool);
+            for (const auto &v : visits)
+                CHECK(v == 1);
+        }
+    }
+
+    SECTION("ranges that don't start at 0, and empty ones") {
+        thread_pool pool{3};
+        std::atomic<std::size_t> sum{0}, calls{0};
+        parallel_for(
+            10, 20, 3,
+            [&sum](std::size_t begin, std::size_t end) {
+                for (auto i = begin; i < end; i++)
+                    sum += i;
+            },
+            pool);
+        CHECK(sum == 145);
+        parallel_for(
+            5, 5, 0,
+            [&calls](std::size_t, std::size_t) {
+                calls++;
+            },
+            pool);
+        CHECK(calls == 0);
+    }
+
+    SECTION("a pool of one runs the loop on the calling thread") {
+        thread_pool pool{1};
+        std::set<std::thread::id> threads;
+        parallel_for(
+            0, 100, 1,
+            [&threads](std::size_t, std::size_t) {
+                threads.insert(std::this_thread::get_id());
+            },
+            pool);
+        CHECK(threads == std::set<std::thread::id>{std::this_thread::get_id()});
+    }
+
+    SECTION("loops nested in pool tasks don't run out of threads") {
+        // Every worker is busy with an outer chunk, so the inner loops have to be done by the threads that start them
+        thread_pool pool{2};
+        std::atomic<int> n{0};
+        parallel_for(
+            0, 8, 1,
+            [&n, &pool](std::size_t, std::size_t) {
+                parallel_for(
+                    0, 100, 1,
+                    [&n](std::size_t begin, std::size_t end) {
+                        n += static_cast<int>(end - begin);
+                    },
+                    pool);
+            },
+            pool);
+        CHECK(n == 800);
+    }
+
+    SECTION("the first exception is rethrown on the calling thread") {
+        thread_pool pool{4};
+        CHECK_THROWS_AS(parallel_for(
+                            0, 1000, 1,
+                            [](std::size_t begin, std::size_t) {
+                                if (begin == 500)
+                                    throw std::runtime_error{"oops"};
+                            },
+                            pool),
+                        std::runtime_error);
+    }
+
+    SECTION("time the calling thread spends waiting for the others is counted") {
+        // Whichever chunk the worker gets, the calling thread finishes the other one first and then has to wait
+        thread_pool pool{2};
+        const auto caller = std::this_thread::get_id();
+        std::atomic<bool> worker_started{false};
+        const auto before = parallel_wait_ns();
+        parallel_for(
+            0, 2, 1,
+            [caller, &worker_started](std::size_t, std::size_t) {
+                if (std::this_thread::get_id() != caller) {
+                    worker_started = true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                    return;
+                }
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+                while (!worker_started && std::chrono::steady_clock::now() < deadline)
+                    std::this_thread::yield();
+            },
+            pool);
+        CHECK(parallel_wait_ns() - before >= 20'000'000);
+    }
+}
+
+TEST_CASE("parallel_reduce", "[util][parallel]") {
+    SECTION("sums agree with summing in order") {
+        for (const unsigned workers : {1U, 2U, 5U}) {
+            thread_pool pool{workers};
+            const auto sum = parallel_reduce(
+                1, 100001, 0, std::uint64_t{0},
+                [](std::uint64_t &acc, std::size_t begin, std::size_t end) {
+                    for (auto i = begin; i < end; i++)
+                        acc += i;
+                },
+                [](std::uint64_t a, std::uint64_t b) {
+                    return a + b;
+                },
+                pool);
+            CHECK(sum == 5000050000ULL);
+        }
+    }
+
+    SECTION("each thread folds into its own accumulator") {
+        // Counting the accumulators that get combined: no more than one per thread, however many chunks there are
+        thread_pool pool{3};
+        const auto merged = parallel_reduce(
+            0, 10000, 1, std::vector<std::size_t>{},
+            [](std::vector<std::size_t> &acc, std::size_t begin, std::size_t) {
+                if (acc.empty())
+                    acc.push_back(0);
+                acc[0] += begin;
+            },
+            [](std::vector<std::size_t> a, std::vector<std::size_t> b) {
+                a.insert(std::end(a), std::begin(b), std::end(b));
+                return a;
+            },
+            pool);
+        CHECK(!merged.empty());
+        CHECK(merged.size() <= pool.size());
+        std::size_t total = 0;
+        for (const auto x : merged)
+            total += x;
+        CHECK(total == 49995000);
+    }
+
+    SECTION("an empty range gives the identity") {
+        const auto product = parallel_reduce(
+            3, 3, 0, 1,
+            [](int &acc, std::size_t, std::size_t) {
+                acc = 0;
+            },
+            [](int a, int b) {
+                return a * b;
+            });
+        CHECK(product == 1);
+    }
+}
+
+TEST_CASE("thread_pool default size", "[util][parallel]") {
+    const auto before = thread_pool::default_size();
+    CHECK(before >= 1);
+    thread_pool::set_default_size(3);
+    CHECK(thread_pool::default_size() == 3);
+    CHECK(thread_pool{}.size() == 3);
+    thread_pool::set_default_size(0);
+    CHECK(thread_pool::default_size() == before);
+}
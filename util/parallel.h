@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "thread_pool.h"
+
+#pragma once
+
+// Data-parallel loops on a thread_pool, by default thread_pool::shared(). A loop over the indices [first, last) is cut
+// into chunks of grain indices, and the calling thread and up to pool.size() - 1 of the pool's workers each claim
+// chunk after chunk until there are none left, so a thread whose chunks turn out cheap just claims more of them. The
+// calling thread works through chunks rather than waiting for the workers, so loops can be nested in pool tasks (e.g.
+// a day's loop inside a run of every day at once) without running out of threads, and with a pool of one (-j 1) a loop
+// runs on the calling thread alone. A grain of 0 picks one that gives every thread several chunks.
+//
+// Bodies run concurrently, so they mustn't share anything mutable, including the calling thread's arena: each thread
+// allocates from its own current_arena(), which on the workers is the default resource. If a body throws, chunks that
+// haven't been claimed yet are skipped and the first exception is rethrown on the calling thread.
+namespace parallel_detail {
+
+// See parallel_wait_ns()
+inline std::atomic<std::uint64_t> wait_ns{0};
+
+class loop {
+    const std::size_t first, last, grain, chunks;
+    std::atomic<std::size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Threads inside the loop's body, which the calling thread waits for before it returns
+    std::size_t active = 0;
+    std::exception_ptr error;
+
+public:
+    loop(std::size_t first, std::size_t last, std::size_t grain)
+        : first{first}, last{last}, grain{grain}, chunks{(last - first + grain - 1) / grain} {}
+
+    std::size_t size() const {
+        return chunks;
+    }
+
+    // Claims the next chunk, [begin, end). Returns false once they have all been claimed.
+    bool claim(std::size_t &begin, std::size_t &end) {
+        const auto k = next++;
+        if (k >= chunks)
+            return false;
+        begin = first + k * grain;
+        end = std::min(begin + grain, last);
+        return true;
+    }
+
+    // Counts the calling thread in from the start, so that workers can't find the loop finished before it has begun
+    void enter() {
+        std::lock_guard<std::mutex> lock{mutex};
+        active++;
+    }
+
+    // Signs a worker up to run the body, unless every chunk has been claimed already, in which case the calling thread
+    // may have returned and the body must not be touched
+    bool join() {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (next >= chunks)
+            return false;
+        active++;
+        return true;
+    }
+
+    void leave(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (e && !error) {
+            error = e;
+            next = chunks; // no more chunks for anyone
+        }
+        if (--active == 0)
+            cv.notify_all();
+    }
+
+    // Waits for every worker that joined to leave, then rethrows the first exception any thread's body threw
+    void wait() {
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] {
+            return active == 0;
+        });
+        wait_ns += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// Runs participant(l) on this thread and on up to pool.size() - 1 workers, where participant claims and runs chunks
+// of l until there are none left, and returns once they have all finished
+template <class Participant>
+void run(thread_pool &pool, std::size_t first, std::size_t last, std::size_t grain, Participant &participant) {
+    if (first >= last)
+        return;
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, (last - first) / (8 * pool.size()));
+    // Shared so that workers that only get round to the loop after it has finished still have something to look at
+    const auto l = std::make_shared<loop>(first, last, grain);
+    l->enter();
+
+    const auto helpers = std::min(pool.size() - 1, l->size() - 1);
+    for (std::size_t i = 0; i < helpers; i++)
+        pool.submit([l, &participant] {
+            if (!l->join())
+                return;
+            std::exception_ptr e;
+            try {
+                participant(*l);
+            } catch (...) {
+                e = std::current_exception();
+            }
+            l->leave(e);
+        });
+
+    std::exception_ptr e;
+    try {
+        participant(*l);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    l->leave(e);
+    l->wait();
+}
+
+} // namespace parallel_detail
+
+// How long, in nanoseconds, the threads that started parallel loops have spent waiting for the other threads to finish
+// their last chunks, in total since the program started. The difference over a run is the time lost to chunks being
+// shared out unevenly, or to workers being late to join, rather than spent working.
+inline std::uint64_t parallel_wait_ns() {
+    return parallel_detail::wait_ns;
+}
+
+// Calls body(begin, end) for consecutive ranges of about grain indices that together cover [first, last)
+template <class F>
+void parallel_for(std::size_t first, std::size_t last, std::size_t grain, F &&body,
+                  thread_pool &pool = thread_pool::shared()) {
+    auto participant = [&body](parallel_detail::loop &l) {
+        for (std::size_t begin, end; l.claim(begin, end);)
+            body(begin, end);
+    };
+    parallel_detail::run(pool, first, last, grain, participant);
+}
+
+// Folds every index in [first, last) into an accumulator with body(acc, begin, end), one range of about grain indices
+// at a time. Each thread has an accumulator of its own, starting from identity, and they are folded together with
+// combine(a, b) once the thread has finished, so combine must be associative and commutative.
+template <class T, class F, class Combine>
+T parallel_reduce(std::size_t first, std::size_t last, std::size_t grain, T identity, F &&body, Combine &&combine,
+                  thread_pool &pool = thread_pool::shared()) {
+    std::mutex mutex;
+    auto result = identity;
+    auto participant = [&](parallel_detail::loop &l) {
+        auto acc = identity;
+        for (std::size_t begin, end; l.claim(begin, end);)
+            body(acc, begin, end);
+        std::lock_guard<std::mutex> lock{mutex};
+        result = combine(std::move(result), std::move(acc));
+    };
+    parallel_detail::run(pool, first, last, grain, participant);
+    return result;
+}
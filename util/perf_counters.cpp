@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#endif
+
+#include "perf_counters.h"
+
+static double now_ns() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef __linux__
+static int open_counter(std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // The kernel multiplexes counters when there are more of them than hardware registers, so ask for the timings
+    // needed to scale the counts back up
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+perf_counters::perf_counters() {
+    constexpr std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    fds[Cycles] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    if (fds[Cycles] == -1)
+        err = std::strerror(errno); // The rest are unlikely to fare any better but try anyway
+    fds[Instructions] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1DMisses] = open_counter(PERF_TYPE_HW_CACHE, l1d_read_miss);
+    fds[LLCMisses] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds[BranchMisses] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    if (available())
+        err.clear();
+}
+
+perf_counters::~perf_counters() {
+    for (const auto fd : fds)
+        if (fd != -1)
+            close(fd);
+}
+
+void perf_counters::start() {
+    for (const auto fd : fds) {
+        if (fd == -1)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    start_ns = now_ns();
+}
+
+perf_counters::sample perf_counters::stop() {
+    sample s;
+    s.ns = now_ns() - start_ns;
+
+    for (auto e = 0; e < NumEvents; e++) {
+        if (fds[e] == -1)
+            continue;
+        ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        std::uint64_t values[3]; // value, time enabled, time running
+        if (read(fds[e], values, sizeof values) != sizeof values)
+            continue;
+        if (values[2] == 0)
+            s.counts[e] = 0; // Never got scheduled onto the PMU
+        else if (values[2] < values[1])
+            s.counts[e] = static_cast<std::uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+        else
+            s.counts[e] = values[0];
+    }
+
+    return s;
+}
+#else
+perf_counters::perf_counters() : err{"perf_event_open is only available on Linux"} {
+    fds.fill(-1);
+}
+
+perf_counters::~perf_counters() {}
+
+void perf_counters::start() {
+    start_ns = now_ns();
+}
+
+perf_counters::sample perf_counters::stop() {
+    sample s;
+    s.ns = now_ns() - start_ns;
+    return s;
+}
+#endif
+
+bool perf_counters::available() const {
+    return std::any_of(std::cbegin(fds), std::cend(fds), [](int fd) {
+        return fd != -1;
+    });
+}
+
+const char *perf_counters::name(event e) {
+    switch (e) {
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case L1DMisses: return "L1d misses";
+    case LLCMisses: return "LLC misses";
+    case BranchMisses: return "branch misses";
+    default: return "?";
+    }
+}
+
+#ifdef TESTING
+TEST_CASE("perf_counters", "[util][perf_counters]") {
+    perf_counters counters;
+    CHECK(counters.available() == counters.error().empty());
+
+    counters.start();
+    volatile std::uint64_t x = 0;
+    for (auto i = 0; i < 100000; i++)
+        x = x + i;
+    const auto s = counters.stop();
+
+    CHECK(s.ns > 0);
+    if (counters.available()) {
+        // Whichever counters did open should have seen the loop
+        if (s.counts[perf_counters::Instructions])
+            CHECK(*s.counts[perf_counters::Instructions] >= 100000);
+    } else {
+        for (const auto &c : s.counts)
+            CHECK(!c);
+    }
+}
+#endif
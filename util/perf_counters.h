@@ -0,0 +1,50 @@
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#pragma once
+
+// Hardware performance counters for the calling thread, read through perf_event_open(2). Counting only covers user
+// space so that it works under the default perf_event_paranoid setting. Any counter the kernel or CPU refuses to open
+// is simply left out; if none of them can be opened at all then available() is false and error() says why, but
+// wall-clock time is still measured either way.
+class perf_counters {
+public:
+    enum event {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        NumEvents
+    };
+
+    struct sample {
+        double ns = 0;
+        // Empty for counters that could not be opened
+        std::array<std::optional<std::uint64_t>, NumEvents> counts;
+    };
+
+private:
+    std::array<int, NumEvents> fds;
+    std::string err;
+    double start_ns = 0;
+
+public:
+    perf_counters();
+    perf_counters(const perf_counters &other) = delete;
+    ~perf_counters();
+
+    perf_counters &operator=(const perf_counters &other) = delete;
+
+    bool available() const;
+    const std::string &error() const {
+        return err;
+    }
+
+    void start();
+    sample stop();
+
+    static const char *name(event e);
+};
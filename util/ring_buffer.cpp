@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ring_buffer.h"
+
+TEST_CASE("ring_buffer", "[util][ring_buffer]") {
+    SECTION("first in, first out, up to its capacity") {
+        ring_buffer<int> ring{3};
+        REQUIRE(ring.capacity() == 4);
+
+        int x;
+        CHECK(!ring.try_pop(x));
+        for (auto i = 0; i < 4; i++)
+            CHECK(ring.try_push(i));
+        CHECK(!ring.try_push(4));
+
+        // Go round the ring a few times
+        for (auto i = 4; i < 20; i++) {
+            REQUIRE(ring.try_pop(x));
+            CHECK(x == i - 4);
+            CHECK(ring.try_push(i));
+        }
+        for (auto i = 16; i < 20; i++)
+            CHECK(ring.pop() == i);
+        CHECK(!ring.try_pop(x));
+    }
+
+    SECTION("every value pushed by several threads is popped exactly once") {
+        constexpr auto producers = 3, consumers = 3;
+        constexpr std::uint64_t per_producer = 20000;
+        ring_buffer<std::uint64_t> ring{16};
+
+        std::vector<std::thread> threads;
+        std::vector<std::uint64_t> sums(consumers), counts(consumers);
+        for (auto p = 0; p < producers; p++)
+            threads.emplace_back([&ring, p] {
+                for (std::uint64_t i = 1; i <= per_producer; i++)
+                    ring.push(p * per_producer + i);
+            });
+        for (auto c = 0; c < consumers; c++)
+            threads.emplace_back([&ring, &sums, &counts, c] {
+                // Zero tells a consumer to stop
+                for (std::uint64_t x; (x = ring.pop());) {
+                    sums[c] += x;
+                    counts[c]++;
+                }
+            });
+
+        for (auto p = 0; p < producers; p++)
+            threads[p].join();
+        for (auto c = 0; c < consumers; c++)
+            ring.push(0);
+        for (auto c = 0; c < consumers; c++)
+            threads[producers + c].join();
+
+        const auto n = producers * per_producer;
+        std::uint64_t sum = 0, count = 0;
+        for (auto c = 0; c < consumers; c++) {
+            sum += sums[c];
+            count += counts[c];
+        }
+        CHECK(count == n);
+        CHECK(sum == n * (n + 1) / 2);
+    }
+}
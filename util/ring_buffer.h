@@ -0,0 +1,100 @@
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#pragma once
+
+// A bounded queue for handing work between threads without locks, which any number of threads may push to and pop
+// from at once. It is Dmitry Vyukov's bounded MPMC queue: each cell carries a sequence number saying whether it is
+// ready to be written or read on the current lap around the ring, and producers and consumers each claim a cell by
+// bumping their own counter with a compare-and-swap. The capacity is rounded up to a power of two.
+//
+// push() and pop() wait (yielding the CPU) while the ring is full or empty, which suits pipeline stages that run for
+// the whole of a job; try_push() and try_pop() don't. T should be cheap to copy, like a pointer or an index.
+template <class T>
+class ring_buffer {
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask;
+    // On cache lines of their own so that producers and consumers don't slow each other down
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+
+public:
+    explicit ring_buffer(std::size_t capacity) : cells{new cell[round_up(capacity)]}, mask{round_up(capacity) - 1} {
+        for (std::size_t i = 0; i <= mask; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ring_buffer(const ring_buffer &other) = delete;
+
+    ring_buffer &operator=(const ring_buffer &other) = delete;
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    bool try_push(T value) {
+        auto pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &c = cells[pos & mask];
+            const auto seq = c.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::move(value);
+                    c.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full: the cell still holds a value from the last lap
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T &value) {
+        auto pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &c = cells[pos & mask];
+            const auto seq = c.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(c.value);
+                    c.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty: nothing has been written to the cell on this lap yet
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void push(T value) {
+        while (!try_push(value))
+            std::this_thread::yield();
+    }
+
+    T pop() {
+        T value;
+        while (!try_pop(value))
+            std::this_thread::yield();
+        return value;
+    }
+};
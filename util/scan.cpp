@@ -0,0 +1,220 @@
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#endif
+
+#include "scan.h"
+
+namespace {
+
+void scan_all_scalar(std::string_view text, std::vector<std::uint32_t> &out) {
+    scanner s{text};
+    for (std::uint32_t n; s.next(n);)
+        out.push_back(n);
+}
+
+// Parses the number starting at each set bit of starts, which flags the first digit of each number in the 64 bytes of
+// text from base on
+inline void scan_starts(std::string_view text, std::size_t base, std::uint64_t starts, std::vector<std::uint32_t> &out) {
+    for (; starts; starts &= starts - 1) {
+        scanner s{text.substr(base + __builtin_ctzll(starts))};
+        out.push_back(s.number<std::uint32_t>());
+    }
+}
+
+// The vector variants differ only in how they find the digits in each 64 bytes, which digits_at() does with the
+// instructions of one level. This is inlined into the target-specific function for that level, and digits_at() into
+// it, so that the loop is compiled with the same instructions. A number starts at every digit that doesn't follow
+// another, including a digit at the end of the previous block.
+template <std::uint64_t (*digits_at)(const char *)>
+[[gnu::always_inline]] inline void scan_blocks(std::string_view text, std::vector<std::uint32_t> &out) {
+    std::uint64_t last_was_digit = 0;
+    std::size_t i = 0;
+    for (; i + 64 <= text.size(); i += 64) {
+        const auto digits = digits_at(text.data() + i);
+        scan_starts(text, i, digits & ~(digits << 1 | last_was_digit), out);
+        last_was_digit = digits >> 63;
+    }
+
+    std::uint64_t digits = 0;
+    for (auto j = i; j < text.size(); j++)
+        digits |= std::uint64_t{static_cast<unsigned char>(text[j] - '0') < 10} << (j - i);
+    scan_starts(text, i, digits & ~(digits << 1 | last_was_digit), out);
+}
+
+#ifdef SCAN_X86
+__attribute__((target("sse2"))) std::uint64_t digits_sse2(const char *p) {
+    std::uint64_t digits = 0;
+    for (auto k = 0; k < 4; k++) {
+        const auto d = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * k)), _mm_set1_epi8('0'));
+        // Digits are the bytes where d <= 9 unsigned, i.e. min(d, 9) == d
+        const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d));
+        digits |= std::uint64_t{mask} << (16 * k);
+    }
+    return digits;
+}
+
+__attribute__((target("avx2"))) std::uint64_t digits_avx2(const char *p) {
+    std::uint64_t digits = 0;
+    for (auto k = 0; k < 2; k++) {
+        const auto d = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * k)),
+                                       _mm256_set1_epi8('0'));
+        const unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d));
+        digits |= std::uint64_t{mask} << (32 * k);
+    }
+    return digits;
+}
+
+__attribute__((target("avx512f,avx512bw"))) std::uint64_t digits_avx512(const char *p) {
+    const auto d = _mm512_sub_epi8(_mm512_loadu_si512(p), _mm512_set1_epi8('0'));
+    return _mm512_cmplt_epu8_mask(d, _mm512_set1_epi8(10));
+}
+
+__attribute__((target("sse2"))) void scan_all_sse2(std::string_view text, std::vector<std::uint32_t> &out) {
+    scan_blocks<digits_sse2>(text, out);
+}
+
+__attribute__((target("avx2"))) void scan_all_avx2(std::string_view text, std::vector<std::uint32_t> &out) {
+    scan_blocks<digits_avx2>(text, out);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void scan_all_avx512(std::string_view text,
+                                                                  std::vector<std::uint32_t> &out) {
+    scan_blocks<digits_avx512>(text, out);
+}
+#endif
+
+const simd_kernel<void(std::string_view, std::vector<std::uint32_t> &)> scan_all_kernel{
+    {simd_level::Scalar, scan_all_scalar},
+#ifdef SCAN_X86
+    {simd_level::SSE2, scan_all_sse2},
+    {simd_level::AVX2, scan_all_avx2},
+    {simd_level::AVX512, scan_all_avx512},
+#endif
+};
+
+} // namespace
+
+void scan_all(std::string_view text, std::vector<std::uint32_t> &out, simd_level level) {
+    scan_all_kernel.variant(level)(text, out);
+}
+
+#ifdef TESTING
+TEST_CASE("scanner", "[util][scan]") {
+    SECTION("numbers of every length") {
+        std::uint64_t expected = 0;
+        for (auto digits = 1; digits <= 19; digits++) {
+            expected = expected * 10 + digits % 10;
+            const auto text = std::to_string(expected);
+            scanner s{text};
+            CHECK(s.number<std::uint64_t>() == expected);
+            CHECK(s.empty());
+        }
+    }
+
+    SECTION("next skips separators") {
+        scanner s{"3   4\n12|345,6789: 10 11 12345678901"};
+        std::vector<std::uint64_t> v;
+        for (std::uint64_t n; s.next(n);)
+            v.push_back(n);
+        CHECK(v == std::vector<std::uint64_t>{3, 4, 12, 345, 6789, 10, 11, 12345678901});
+    }
+
+    SECTION("stops at the end of the number") {
+        scanner s{"190: 10 19"};
+        CHECK(s.number<std::uint32_t>() == 190);
+        s.expect(':');
+        CHECK(s.rest() == " 10 19");
+        CHECK_THROWS_AS(s.expect(':'), std::invalid_argument);
+    }
+
+    SECTION("signed numbers") {
+        scanner s{"-12 x-3 - 4 -9223372036854775808"};
+        std::vector<std::int64_t> v;
+        for (std::int64_t n; s.next(n);)
+            v.push_back(n);
+        CHECK(v == std::vector<std::int64_t>{-12, -3, 4, std::numeric_limits<std::int64_t>::min()});
+    }
+
+    SECTION("unsigned types treat a minus sign as a separator") {
+        scanner s{"-12"};
+        std::uint32_t n;
+        REQUIRE(s.next(n));
+        CHECK(n == 12);
+    }
+
+    SECTION("limits") {
+        scanner a{"4294967295 4294967296"};
+        std::uint32_t n;
+        REQUIRE(a.next(n));
+        CHECK(n == std::numeric_limits<std::uint32_t>::max());
+        CHECK_THROWS_AS(a.next(n), std::out_of_range);
+
+        scanner b{"18446744073709551615 18446744073709551616 000000000000000000000000001"};
+        std::uint64_t m;
+        REQUIRE(b.next(m));
+        CHECK(m == std::numeric_limits<std::uint64_t>::max());
+        CHECK_THROWS_AS(b.next(m), std::out_of_range);
+
+        scanner c{"000000000000000000000000001"};
+        CHECK(c.number<std::uint64_t>() == 1);
+
+        scanner d{"2147483648"};
+        CHECK_THROWS_AS(d.number<std::int32_t>(), std::out_of_range);
+    }
+
+    SECTION("not a number") {
+        scanner s{"x1"};
+        CHECK_THROWS_AS(s.number<std::uint32_t>(), std::invalid_argument);
+        scanner t{""};
+        CHECK_THROWS_AS(t.number<std::uint32_t>(), std::invalid_argument);
+        std::uint32_t n;
+        CHECK(!t.next(n));
+    }
+}
+
+TEST_CASE("scan_all", "[util][scan]") {
+    // Numbers straddling the 64-byte blocks the vector variants work in, and in the scalar tail after the last one
+    std::string text;
+    for (std::uint32_t i = 0; text.size() < 300; i++)
+        text += std::to_string(i * 7919 % 100003) + (i % 3 ? " " : ",\n") + (i % 5 ? "" : "ab|c-");
+    text += "4294967295";
+
+    std::vector<std::uint32_t> expected;
+    scanner s{text};
+    for (std::uint32_t n; s.next(n);)
+        expected.push_back(n);
+
+    for (std::size_t i = 0; i <= static_cast<std::size_t>(detected_simd_level()); i++) {
+        const auto level = static_cast<simd_level>(i);
+        INFO("level " << simd_level_name(level));
+        for (std::size_t start = 0; start < 70; start += 7) {
+            std::vector<std::uint32_t> found, expected_from_start;
+            scan_all(std::string_view{text}.substr(start), found, level);
+            scan_all(std::string_view{text}.substr(start), expected_from_start, simd_level::Scalar);
+            CHECK(found == expected_from_start);
+        }
+
+        std::vector<std::uint32_t> found{42};
+        scan_all(text, found, level);
+        REQUIRE(found.size() == expected.size() + 1);
+        CHECK(found[0] == 42);
+        CHECK(std::equal(std::begin(expected), std::end(expected), std::begin(found) + 1));
+
+        found.clear();
+        scan_all("", found, level);
+        CHECK(found.empty());
+        CHECK_THROWS_AS(scan_all(std::string(70, ' ') + "4294967296", found, level), std::out_of_range);
+    }
+}
+#endif
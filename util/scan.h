@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "cpu_dispatch.h"
+
+#pragma once
+
+// Integer parsing straight out of a buffer of text, for parsers where throughput matters. Digits are converted eight
+// at a time with SWAR arithmetic on 64-bit words, so a typical puzzle number takes one load and a handful of multiplies
+// rather than a loop over its characters.
+//
+// Like std::stoul, numbers that don't fit in the type asked for throw std::out_of_range, and asking for a number where
+// there isn't one throws std::invalid_argument.
+namespace scan_detail {
+
+// Reads eight bytes from p, or whatever is left before end padded with NULs, which aren't digits
+inline std::uint64_t load8(const char *p, const char *end) {
+    std::uint64_t chunk = 0;
+    if (end - p >= 8)
+        std::memcpy(&chunk, p, 8);
+    else
+        std::memcpy(&chunk, p, end - p);
+    return chunk;
+}
+
+// How many of the bytes at the start of chunk (the lowest addressed, since we're little-endian) are digits. A byte is
+// flagged if it is below '0' (the subtraction borrows into its top bit) or above '9' (the addition carries into it).
+// Borrows and carries can spill into the byte above a flagged one, but only the first flag matters.
+inline unsigned digit_run(std::uint64_t chunk) {
+    const auto flags = ((chunk - 0x3030303030303030ULL) | (chunk + 0x4646464646464646ULL)) & 0x8080808080808080ULL;
+    return flags ? __builtin_ctzll(flags) / 8 : 8;
+}
+
+// The value of the first len (1-8) digits in chunk
+inline std::uint32_t parse8(std::uint64_t chunk, unsigned len) {
+    // Keep just the digits' values and shift them up so that the bytes below them become leading zeros
+    auto v = (chunk & 0x0F0F0F0F0F0F0F0FULL) << (8 * (8 - len));
+    // Pairs of digits, then fours, then all eight
+    v = v * 10 + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+         (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+        32;
+    return static_cast<std::uint32_t>(v);
+}
+
+constexpr std::uint64_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+[[noreturn]] inline void out_of_range(const char *begin, const char *end) {
+    throw std::out_of_range{"number out of range: " + std::string{begin, end}};
+}
+
+} // namespace scan_detail
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "scan.h's digit tricks assume a little-endian machine");
+
+class scanner {
+    const char *p, *end;
+
+    static bool is_digit(char c) {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    // Parses the digits at p (there must be at least one) as an unsigned number no bigger than max
+    std::uint64_t magnitude(std::uint64_t max) {
+        using namespace scan_detail;
+        const auto *const begin = p;
+        std::uint64_t n = 0;
+        for (;;) {
+            const auto chunk = load8(p, end);
+            const auto len = digit_run(chunk);
+            if (len == 0)
+                break;
+            if (__builtin_mul_overflow(n, pow10[len], &n) || __builtin_add_overflow(n, parse8(chunk, len), &n))
+                out_of_range(begin, p + len);
+            p += len;
+            if (len < 8)
+                break;
+        }
+        if (n > max)
+            out_of_range(begin, p);
+        return n;
+    }
+
+public:
+    explicit scanner(std::string_view s) : p{s.data()}, end{s.data() + s.size()} {}
+
+    bool empty() const {
+        return p == end;
+    }
+
+    // Everything that hasn't been scanned yet
+    std::string_view rest() const {
+        return std::string_view{p, static_cast<std::size_t>(end - p)};
+    }
+
+    // Parses the number that starts right here
+    template <class T>
+    T number() {
+        static_assert(std::is_integral_v<T>, "scanner only parses integers");
+        auto negative = false;
+        if constexpr (std::is_signed_v<T>) {
+            if (p != end && *p == '-' && end - p > 1 && is_digit(p[1])) {
+                negative = true;
+                p++;
+            }
+        }
+        if (p == end || !is_digit(*p))
+            throw std::invalid_argument{"not a number: " + std::string{rest().substr(0, 16)}};
+
+        using U = std::make_unsigned_t<T>;
+        const std::uint64_t max = std::numeric_limits<T>::max();
+        if (negative)
+            return static_cast<T>(U{0} - static_cast<U>(magnitude(max + 1)));
+        return static_cast<T>(magnitude(max));
+    }
+
+    // Skips anything that can't start a number (digits, or a minus sign followed by a digit if T is signed) then
+    // parses the number that follows. Returns false, having skipped to the end, if there are no more numbers.
+    template <class T>
+    bool next(T &n) {
+        for (; p != end; p++) {
+            if (is_digit(*p))
+                break;
+            if constexpr (std::is_signed_v<T>)
+                if (*p == '-' && end - p > 1 && is_digit(p[1]))
+                    break;
+        }
+        if (p == end)
+            return false;
+        n = number<T>();
+        return true;
+    }
+
+    // Consumes c, which must come next
+    void expect(char c) {
+        if (p == end || *p != c)
+            throw std::invalid_argument{std::string{"expected '"} + c + "' but found: " +
+                                        std::string{rest().substr(0, 16)}};
+        p++;
+    }
+};
+
+// Appends every number in text to out, just as calling scanner::next<std::uint32_t>() until it returns false would, but
+// finding where the numbers start a vector of bytes at a time with the best instructions the CPU has rather than
+// stepping over the bytes between them one by one. For inputs that are nothing but numbers and separators.
+void scan_all(std::string_view text, std::vector<std::uint32_t> &out, simd_level level = best_simd_level());
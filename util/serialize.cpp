@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "serialize.h"
+
+template <class T>
+static T round_trip(const T &x) {
+    byte_writer w;
+    serialize(w, x);
+    byte_reader r{w.view()};
+    auto y = deserialize(r, type_tag<T>{});
+    REQUIRE(r.remaining() == 0);
+    return y;
+}
+
+TEST_CASE("serialize", "[util][serialize]") {
+    SECTION("scalars") {
+        CHECK(round_trip(std::uint32_t{123456}) == 123456);
+        CHECK(round_trip('x') == 'x');
+    }
+
+    SECTION("containers") {
+        const std::vector<std::vector<std::uint32_t>> v{{1, 2, 3}, {}, {4}};
+        CHECK(round_trip(v) == v);
+        const std::map<std::uint32_t, std::set<std::uint32_t>> m{{1, {2, 3}}, {4, {}}};
+        CHECK(round_trip(m) == m);
+        const std::multimap<char, std::array<std::uint8_t, 2>> mm{{'a', {1, 2}}, {'a', {3, 4}}, {'b', {5, 6}}};
+        CHECK(round_trip(mm) == mm);
+        const std::pair<std::size_t, std::size_t> p{7, 8};
+        CHECK(round_trip(p) == p);
+    }
+
+    SECTION("matrices") {
+        const dynamic_matrix<char> m{{'a', 'b', 'c'}, {'d', 'e', 'f'}};
+        const auto n = round_trip(m);
+        REQUIRE(n.rows() == 2);
+        REQUIRE(n.cols() == 3);
+        CHECK(std::equal(std::begin(m), std::end(m), std::begin(n)));
+
+        const bit_matrix b{{"#..#", ".##."}, '#'};
+        CHECK(round_trip(b) == b);
+    }
+
+    SECTION("variants") {
+        using v = std::variant<std::uint8_t, std::vector<std::uint32_t>>;
+        CHECK(round_trip(v{std::uint8_t{7}}) == v{std::uint8_t{7}});
+        CHECK(round_trip(v{std::vector<std::uint32_t>{1, 2}}) == v{std::vector<std::uint32_t>{1, 2}});
+
+        byte_writer w;
+        serialize(w, std::uint64_t{2});
+        byte_reader r{w.view()};
+        CHECK_THROWS_AS(deserialize(r, type_tag<v>{}), std::runtime_error);
+    }
+
+    SECTION("truncated data throws") {
+        byte_writer w;
+        serialize(w, std::vector<std::uint64_t>{1, 2, 3});
+        byte_reader r{w.view().substr(0, w.view().size() - 1)};
+        CHECK_THROWS_AS(deserialize(r, type_tag<std::vector<std::uint64_t>>{}), std::runtime_error);
+    }
+
+    SECTION("absurd sizes throw instead of allocating") {
+        byte_writer w;
+        serialize(w, std::uint64_t{1} << 60);
+        byte_reader r{w.view()};
+        CHECK_THROWS_AS(deserialize(r, type_tag<std::vector<std::vector<std::uint32_t>>>{}), std::runtime_error);
+    }
+}
@@ -0,0 +1,330 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "arena.h"
+#include "bit_matrix.h"
+#include "jagged_array.h"
+#include "matrix.h"
+
+#pragma once
+
+// A compact binary encoding of parsed puzzle inputs, for caching them on disk. Values are written in native byte order
+// with no padding, and sizes as 64-bit counts; containers of arithmetic types are copied in bulk. The encoding isn't
+// portable between machines, which a cache doesn't need.
+//
+// Structs need a serialize/deserialize pair of their own in their own namespace, found by argument-dependent lookup
+// through type_tag. deserialize() throws std::runtime_error if the data runs out before the value is complete, or
+// doesn't describe a valid one. Containers with polymorphic allocators are rebuilt in current_arena().
+
+class byte_writer {
+    std::vector<char> buf;
+
+public:
+    void write(const void *p, std::size_t n) {
+        const auto *c = static_cast<const char *>(p);
+        buf.insert(std::end(buf), c, c + n);
+    }
+
+    std::string_view view() const {
+        return std::string_view{buf.data(), buf.size()};
+    }
+};
+
+class byte_reader {
+    std::string_view in;
+
+public:
+    explicit byte_reader(std::string_view in) : in{in} {}
+
+    void read(void *p, std::size_t n) {
+        if (n > in.size())
+            throw std::runtime_error{"serialized data is truncated"};
+        std::memcpy(p, in.data(), n);
+        in.remove_prefix(n);
+    }
+
+    std::size_t remaining() const {
+        return in.size();
+    }
+};
+
+// Picks which deserialize() overload to call, since they differ only in their return type
+template <class T>
+struct type_tag {};
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>> serialize(byte_writer &w, const T &x);
+template <class T, class U>
+void serialize(byte_writer &w, const std::pair<T, U> &p);
+template <class T, std::size_t N>
+void serialize(byte_writer &w, const std::array<T, N> &a);
+template <class T, class A>
+void serialize(byte_writer &w, const std::vector<T, A> &v);
+template <class T, class C, class A>
+void serialize(byte_writer &w, const std::set<T, C, A> &s);
+template <class K, class V, class C, class A>
+void serialize(byte_writer &w, const std::map<K, V, C, A> &m);
+template <class K, class V, class C, class A>
+void serialize(byte_writer &w, const std::multimap<K, V, C, A> &m);
+template <class T, class A>
+void serialize(byte_writer &w, const dynamic_matrix<T, A> &m);
+template <class T>
+void serialize(byte_writer &w, const jagged_array<T> &a);
+inline void serialize(byte_writer &w, const bit_matrix &m);
+template <class... Ts>
+void serialize(byte_writer &w, const std::variant<Ts...> &v);
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, T> deserialize(byte_reader &r, type_tag<T>);
+template <class T, class U>
+std::pair<T, U> deserialize(byte_reader &r, type_tag<std::pair<T, U>>);
+template <class T, std::size_t N>
+std::array<T, N> deserialize(byte_reader &r, type_tag<std::array<T, N>>);
+template <class T, class A>
+std::vector<T, A> deserialize(byte_reader &r, type_tag<std::vector<T, A>>);
+template <class T, class C, class A>
+std::set<T, C, A> deserialize(byte_reader &r, type_tag<std::set<T, C, A>>);
+template <class K, class V, class C, class A>
+std::map<K, V, C, A> deserialize(byte_reader &r, type_tag<std::map<K, V, C, A>>);
+template <class K, class V, class C, class A>
+std::multimap<K, V, C, A> deserialize(byte_reader &r, type_tag<std::multimap<K, V, C, A>>);
+template <class T, class A>
+dynamic_matrix<T, A> deserialize(byte_reader &r, type_tag<dynamic_matrix<T, A>>);
+template <class T>
+jagged_array<T> deserialize(byte_reader &r, type_tag<jagged_array<T>>);
+inline bit_matrix deserialize(byte_reader &r, type_tag<bit_matrix>);
+template <class... Ts>
+std::variant<Ts...> deserialize(byte_reader &r, type_tag<std::variant<Ts...>>);
+
+namespace serialize_detail {
+
+template <class T>
+constexpr bool is_bulk = std::is_arithmetic_v<T>;
+
+inline void write_size(byte_writer &w, std::size_t n) {
+    const std::uint64_t n64 = n;
+    w.write(&n64, sizeof n64);
+}
+
+// Rejects counts that can't possibly fit in what's left, so that corrupt data can't ask for a huge allocation
+inline std::size_t read_size(byte_reader &r, std::size_t min_element_size) {
+    std::uint64_t n;
+    r.read(&n, sizeof n);
+    if (min_element_size && n > r.remaining() / min_element_size)
+        throw std::runtime_error{"serialized data is truncated"};
+    return static_cast<std::size_t>(n);
+}
+
+template <class Container>
+void serialize_each(byte_writer &w, const Container &c) {
+    write_size(w, c.size());
+    for (const auto &x : c)
+        serialize(w, x);
+}
+
+template <class Container, class T>
+Container deserialize_each(byte_reader &r) {
+    const auto n = read_size(r, 1);
+    Container c{arena_allocator<typename Container::allocator_type>()};
+    for (std::size_t i = 0; i < n; i++)
+        c.insert(std::end(c), deserialize(r, type_tag<T>{}));
+    return c;
+}
+
+// Reads a value of the variant's alternative number index, which is I or one after it
+template <class Variant, std::size_t I = 0>
+Variant deserialize_alternative(byte_reader &r, std::size_t index) {
+    if constexpr (I == std::variant_size_v<Variant>) {
+        throw std::runtime_error{"serialized variant holds an unknown alternative"};
+    } else {
+        if (index == I)
+            return Variant{std::in_place_index<I>, deserialize(r, type_tag<std::variant_alternative_t<I, Variant>>{})};
+        return deserialize_alternative<Variant, I + 1>(r, index);
+    }
+}
+
+} // namespace serialize_detail
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>> serialize(byte_writer &w, const T &x) {
+    w.write(&x, sizeof x);
+}
+
+template <class T, class U>
+void serialize(byte_writer &w, const std::pair<T, U> &p) {
+    serialize(w, p.first);
+    serialize(w, p.second);
+}
+
+template <class T, std::size_t N>
+void serialize(byte_writer &w, const std::array<T, N> &a) {
+    for (const auto &x : a)
+        serialize(w, x);
+}
+
+template <class T, class A>
+void serialize(byte_writer &w, const std::vector<T, A> &v) {
+    if constexpr (serialize_detail::is_bulk<T>) {
+        serialize_detail::write_size(w, v.size());
+        w.write(v.data(), v.size() * sizeof(T));
+    } else {
+        serialize_detail::serialize_each(w, v);
+    }
+}
+
+template <class T, class C, class A>
+void serialize(byte_writer &w, const std::set<T, C, A> &s) {
+    serialize_detail::serialize_each(w, s);
+}
+
+template <class K, class V, class C, class A>
+void serialize(byte_writer &w, const std::map<K, V, C, A> &m) {
+    serialize_detail::serialize_each(w, m);
+}
+
+template <class K, class V, class C, class A>
+void serialize(byte_writer &w, const std::multimap<K, V, C, A> &m) {
+    serialize_detail::serialize_each(w, m);
+}
+
+template <class T, class A>
+void serialize(byte_writer &w, const dynamic_matrix<T, A> &m) {
+    serialize_detail::write_size(w, m.rows());
+    serialize_detail::write_size(w, m.cols());
+    if constexpr (serialize_detail::is_bulk<T>) {
+        w.write(m.data(), m.rows() * m.cols() * sizeof(T));
+    } else {
+        for (const auto &x : m)
+            serialize(w, x);
+    }
+}
+
+template <class T>
+void serialize(byte_writer &w, const jagged_array<T> &a) {
+    serialize(w, a.values());
+    serialize(w, a.offsets());
+}
+
+inline void serialize(byte_writer &w, const bit_matrix &m) {
+    serialize_detail::write_size(w, m.rows());
+    serialize_detail::write_size(w, m.cols());
+    w.write(m.data(), m.word_count() * sizeof(bit_matrix::word_type));
+}
+
+template <class... Ts>
+void serialize(byte_writer &w, const std::variant<Ts...> &v) {
+    serialize_detail::write_size(w, v.index());
+    std::visit(
+        [&w](const auto &x) {
+            serialize(w, x);
+        },
+        v);
+}
+
+template <class T>
+std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, T> deserialize(byte_reader &r, type_tag<T>) {
+    T x;
+    r.read(&x, sizeof x);
+    return x;
+}
+
+template <class T, class U>
+std::pair<T, U> deserialize(byte_reader &r, type_tag<std::pair<T, U>>) {
+    // Braced initialisation guarantees first is read before second
+    return std::pair<T, U>{deserialize(r, type_tag<T>{}), deserialize(r, type_tag<U>{})};
+}
+
+template <class T, std::size_t N>
+std::array<T, N> deserialize(byte_reader &r, type_tag<std::array<T, N>>) {
+    std::array<T, N> a;
+    for (auto &x : a)
+        x = deserialize(r, type_tag<T>{});
+    return a;
+}
+
+template <class T, class A>
+std::vector<T, A> deserialize(byte_reader &r, type_tag<std::vector<T, A>>) {
+    if constexpr (serialize_detail::is_bulk<T>) {
+        std::vector<T, A> v(serialize_detail::read_size(r, sizeof(T)), arena_allocator<A>());
+        r.read(v.data(), v.size() * sizeof(T));
+        return v;
+    } else {
+        const auto n = serialize_detail::read_size(r, 1);
+        std::vector<T, A> v{arena_allocator<A>()};
+        v.reserve(n);
+        for (std::size_t i = 0; i < n; i++)
+            v.push_back(deserialize(r, type_tag<T>{}));
+        return v;
+    }
+}
+
+template <class T, class C, class A>
+std::set<T, C, A> deserialize(byte_reader &r, type_tag<std::set<T, C, A>>) {
+    return serialize_detail::deserialize_each<std::set<T, C, A>, T>(r);
+}
+
+template <class K, class V, class C, class A>
+std::map<K, V, C, A> deserialize(byte_reader &r, type_tag<std::map<K, V, C, A>>) {
+    return serialize_detail::deserialize_each<std::map<K, V, C, A>, std::pair<K, V>>(r);
+}
+
+template <class K, class V, class C, class A>
+std::multimap<K, V, C, A> deserialize(byte_reader &r, type_tag<std::multimap<K, V, C, A>>) {
+    return serialize_detail::deserialize_each<std::multimap<K, V, C, A>, std::pair<K, V>>(r);
+}
+
+template <class T, class A>
+dynamic_matrix<T, A> deserialize(byte_reader &r, type_tag<dynamic_matrix<T, A>>) {
+    const auto rows = serialize_detail::read_size(r, 0);
+    const auto cols = serialize_detail::read_size(r, 0);
+    if (rows && cols > r.remaining() / rows / sizeof(T))
+        throw std::runtime_error{"serialized data is truncated"};
+    dynamic_matrix<T, A> m{rows, cols, T(), arena_allocator<A>()};
+    if constexpr (serialize_detail::is_bulk<T>) {
+        r.read(m.data(), rows * cols * sizeof(T));
+    } else {
+        for (auto &x : m)
+            x = deserialize(r, type_tag<T>{});
+    }
+    return m;
+}
+
+template <class T>
+jagged_array<T> deserialize(byte_reader &r, type_tag<jagged_array<T>>) {
+    auto values = deserialize(r, type_tag<std::vector<T>>{});
+    auto offsets = deserialize(r, type_tag<std::vector<typename jagged_array<T>::size_type>>{});
+    try {
+        return jagged_array<T>::from_parts(std::move(values), std::move(offsets));
+    } catch (const std::invalid_argument &e) {
+        // Corrupt data, as far as the caller is concerned
+        throw std::runtime_error{e.what()};
+    }
+}
+
+inline bit_matrix deserialize(byte_reader &r, type_tag<bit_matrix>) {
+    const auto rows = serialize_detail::read_size(r, 0);
+    const auto cols = serialize_detail::read_size(r, 0);
+    const auto stride = cols / bit_matrix::word_bits + (cols % bit_matrix::word_bits != 0);
+    if (rows && stride > r.remaining() / rows / sizeof(bit_matrix::word_type))
+        throw std::runtime_error{"serialized data is truncated"};
+    bit_matrix m{rows, cols};
+    r.read(m.data(), m.word_count() * sizeof(bit_matrix::word_type));
+    return m;
+}
+
+template <class... Ts>
+std::variant<Ts...> deserialize(byte_reader &r, type_tag<std::variant<Ts...>>) {
+    const auto index = serialize_detail::read_size(r, 0);
+    return serialize_detail::deserialize_alternative<std::variant<Ts...>>(r, index);
+}
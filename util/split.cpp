@@ -0,0 +1,14 @@
+#include <catch2/catch.hpp>
+
+#include "split.h"
+
+TEST_CASE("split", "[util][split]") {
+    SECTION("next_token") {
+        std::string_view s{"47|53\n97|13"};
+        CHECK(next_token(s, '\n') == "47|53");
+        CHECK(s == "97|13");
+        CHECK(next_token(s, '\n') == "97|13");
+        CHECK(s.empty());
+        CHECK(next_token(s, '\n').empty());
+    }
+}
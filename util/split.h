@@ -0,0 +1,12 @@
+#include <string_view>
+
+#pragma once
+
+// Removes and returns everything in s up to (but not including) the next delim. The delimiter itself is dropped too.
+// If there is no delimiter left then the whole of s is returned and s becomes empty.
+inline std::string_view next_token(std::string_view &s, char delim) {
+    const auto n = s.find(delim);
+    const auto token = s.substr(0, n);
+    s.remove_prefix(n == std::string_view::npos ? s.size() : n + 1);
+    return token;
+}
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <atomic>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#endif
+
+#include "thread_pool.h"
+
+namespace {
+
+// Which pool the current thread works for, if any, and which of its queues is the thread's own
+thread_local const thread_pool *current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+// The innermost live pool_scope's pool on this thread, if there is one
+thread_local thread_pool *scoped_pool = nullptr;
+
+// 0 for one worker per hardware thread
+std::atomic<unsigned> default_workers{0};
+
+} // namespace
+
+unsigned thread_pool::default_size() {
+    const auto n = default_workers.load();
+    return n ? n : std::thread::hardware_concurrency();
+}
+
+void thread_pool::set_default_size(unsigned n) {
+    default_workers = n;
+}
+
+thread_pool &thread_pool::shared() {
+    if (scoped_pool)
+        return *scoped_pool;
+    static thread_pool pool;
+    return pool;
+}
+
+pool_scope::pool_scope(thread_pool &pool) : previous{scoped_pool} {
+    scoped_pool = &pool;
+}
+
+pool_scope::~pool_scope() {
+    scoped_pool = previous;
+}
+
+thread_pool::thread_pool(unsigned n) {
+    // hardware_concurrency() is allowed to return 0 if it can't tell
+    n = std::max(n, 1U);
+    queues.reserve(n);
+    for (unsigned i = 0; i < n; i++)
+        queues.push_back(std::make_unique<queue>());
+    workers.reserve(n);
+    for (unsigned i = 0; i < n; i++)
+        workers.emplace_back(&thread_pool::work, this, i);
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void thread_pool::push(std::function<void()> task) {
+    const auto i = current_pool == this ? current_worker : next_queue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock{queues[i]->mutex};
+        queues[i]->tasks.push_back(std::move(task));
+        pending++;
+    }
+    // Taking the lock means a worker can't be between checking pending and going to sleep, so it can't miss this
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+    }
+    cv.notify_one();
+}
+
+bool thread_pool::pop(std::size_t worker, std::function<void()> &task) {
+    // Own queue first, then everyone else's starting with the next one along so that thieves spread out
+    for (std::size_t k = 0; k < queues.size(); k++) {
+        auto &q = *queues[(worker + k) % queues.size()];
+        std::lock_guard<std::mutex> lock{q.mutex};
+        if (!q.tasks.empty()) {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::work(std::size_t worker) {
+    current_pool = this;
+    current_worker = worker;
+    for (;;) {
+        std::function<void()> task;
+        if (pop(worker, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(lock, [this] {
+            return stopping || pending > 0;
+        });
+        if (stopping && pending == 0)
+            return;
+    }
+}
+
+#ifdef TESTING
+TEST_CASE("thread_pool", "[util][thread_pool]") {
+    SECTION("submit returns the task's result") {
+        thread_pool pool{2};
+        auto a = pool.submit([] {
+            return 6 * 7;
+        });
+        auto b = pool.submit([] {
+            return std::string{"hello"};
+        });
+        CHECK(a.get() == 42);
+        CHECK(b.get() == "hello");
+    }
+
+    SECTION("destructor drains the queue") {
+        std::atomic<int> n{0};
+        {
+            thread_pool pool{3};
+            for (auto i = 0; i < 100; i++)
+                pool.submit([&n] {
+                    n++;
+                });
+        }
+        CHECK(n == 100);
+    }
+
+    SECTION("single worker runs tasks in submission order") {
+        std::vector<int> order;
+        {
+            thread_pool pool{1};
+            for (auto i = 0; i < 10; i++)
+                pool.submit([&order, i] {
+                    order.push_back(i);
+                });
+        }
+        CHECK(order == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    }
+
+    SECTION("idle workers steal from busy ones") {
+        // With one worker stuck on the blocker, the other has to get through all ten tasks, including the ones dealt
+        // to the stuck worker's queue
+        std::promise<void> release;
+        std::atomic<int> n{0};
+        thread_pool pool{2};
+        pool.submit([blocked = release.get_future().share()] {
+            blocked.wait();
+        });
+        for (auto i = 0; i < 10; i++)
+            pool.submit([&n] {
+                n++;
+            });
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+        while (n < 10 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        CHECK(n == 10);
+        release.set_value();
+    }
+
+    SECTION("tasks can submit more tasks") {
+        thread_pool pool{2};
+        auto outer = pool.submit([&pool] {
+            return pool.submit([] {
+                return 42;
+            });
+        });
+        CHECK(outer.get().get() == 42);
+    }
+
+    SECTION("exceptions are delivered through the future") {
+        thread_pool pool{1};
+        auto f = pool.submit([]() -> int {
+            throw std::runtime_error{"oops"};
+        });
+        CHECK_THROWS_AS(f.get(), std::runtime_error);
+    }
+
+    SECTION("pool_scope swaps shared() for another pool on this thread only") {
+        auto &global = thread_pool::shared();
+        thread_pool outer{1}, inner{2};
+        {
+            const pool_scope outer_scope{outer};
+            CHECK(&thread_pool::shared() == &outer);
+            {
+                const pool_scope inner_scope{inner};
+                CHECK(&thread_pool::shared() == &inner);
+                CHECK(std::async(std::launch::async, [] {
+                          return &thread_pool::shared();
+                      }).get() == &global);
+            }
+            CHECK(&thread_pool::shared() == &outer);
+        }
+        CHECK(&thread_pool::shared() == &global);
+    }
+}
+#endif
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#pragma once
+
+// A fixed-size pool of worker threads with a queue each. Tasks submitted from outside the pool are dealt out to the
+// queues in turn, and tasks submitted by a task go on its own worker's queue. Workers take tasks from the front of
+// their own queue and, once that is empty, steal from the front of the others', so a worker stuck on one long task
+// doesn't hold up the ones queued behind it. Tasks therefore start roughly in the order they were submitted (exactly,
+// with a single worker): callers that care about which task starts first (e.g. running the slowest ones first) just
+// need to submit them in that order.
+class thread_pool {
+    struct queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next_queue{0};
+    // Tasks waiting in any queue; workers sleep on cv while there are none
+    std::atomic<std::size_t> pending{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void push(std::function<void()> task);
+    bool pop(std::size_t worker, std::function<void()> &task);
+    void work(std::size_t worker);
+
+public:
+    explicit thread_pool(unsigned n = default_size());
+    thread_pool(const thread_pool &other) = delete;
+    // Waits for every task that has already been submitted to finish
+    ~thread_pool();
+
+    thread_pool &operator=(const thread_pool &other) = delete;
+
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F &&f) {
+        using result_type = std::invoke_result_t<F>;
+        // std::function needs something copyable, which std::packaged_task isn't
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        push([task] {
+            (*task)();
+        });
+        return result;
+    }
+
+    std::size_t size() const {
+        return workers.size();
+    }
+
+    // How many workers a pool has unless told otherwise: one per hardware thread, or however many -j asked for
+    static unsigned default_size();
+    // Sets default_size(), or puts it back to one per hardware thread if n is 0. Pools that already exist, including
+    // shared(), keep the size they were made with.
+    static void set_default_size(unsigned n);
+
+    // The pool that parallel loops (see parallel.h) run on unless given another: the innermost live pool_scope's on
+    // this thread, or else one with default_size() workers, which is started the first time it is asked for and runs
+    // until the program exits.
+    static thread_pool &shared();
+};
+
+// Makes pool the one that thread_pool::shared() returns on this thread for as long as it is in scope, then puts back
+// whichever was before, e.g. to run a phase's loops on a pool of one while measuring it. Scopes nest, and must be
+// ended on the thread that began them. Other threads, including pool's workers, carry on with their own.
+class pool_scope {
+    thread_pool *previous;
+
+public:
+    explicit pool_scope(thread_pool &pool);
+    pool_scope(const pool_scope &other) = delete;
+    ~pool_scope();
+
+    pool_scope &operator=(const pool_scope &other) = delete;
+};
@@ -0,0 +1,25 @@
+#include <catch2/catch.hpp>
+
+#include "timing.h"
+
+TEST_CASE("timing", "[util][timing]") {
+    SECTION("percentile") {
+        const std::vector<double> samples{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        CHECK(percentile(samples, 0.5) == 5);
+        CHECK(percentile(samples, 0.99) == 10);
+        CHECK(percentile(samples, 0) == 1);
+        CHECK(percentile({}, 0.5) == 0);
+    }
+
+    SECTION("summarize") {
+        const auto s = summarize({30, 10, 20});
+        CHECK(s.min == 10);
+        CHECK(s.median == 20);
+        CHECK(s.p99 == 30);
+    }
+
+    SECTION("stopwatch") {
+        stopwatch sw;
+        CHECK(sw.elapsed_ns() >= 0);
+    }
+}
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#pragma once
+
+class stopwatch {
+    using clock = std::chrono::steady_clock;
+    clock::time_point start;
+
+public:
+    stopwatch() : start{clock::now()} {}
+
+    void reset() {
+        start = clock::now();
+    }
+
+    // Nanoseconds since construction or the last reset()
+    double elapsed_ns() const {
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    }
+};
+
+struct summary {
+    double min = 0, median = 0, p99 = 0;
+};
+
+// The value below which fraction p of samples fall, using the nearest-rank method. samples must be sorted.
+inline double percentile(const std::vector<double> &samples, double p) {
+    if (samples.empty())
+        return 0;
+    const auto rank = static_cast<std::size_t>(std::ceil(p * samples.size()));
+    return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+}
+
+inline summary summarize(std::vector<double> samples) {
+    std::sort(std::begin(samples), std::end(samples));
+    summary s;
+    if (!samples.empty()) {
+        s.min = samples.front();
+        s.median = percentile(samples, 0.5);
+        s.p99 = percentile(samples, 0.99);
+    }
+    return s;
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef TESTING
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#endif
+
+#include "trace.h"
+
+// Only compiled in when AOC_TRACING is set. Each thread appends to its own buffer so that recording a span never takes
+// a lock; the buffers are owned by a global list rather than by the threads so that they outlive them.
+namespace {
+
+struct trace_event {
+    const char *name, *arg_name;
+    std::int64_t arg;
+    double start_us, dur_us;
+};
+
+struct thread_buffer {
+    unsigned tid;
+    std::vector<trace_event> events;
+};
+
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+thread_buffer &this_thread_buffer() {
+    thread_local thread_buffer *buffer = [] {
+        std::lock_guard<std::mutex> lock{buffers_mutex};
+        buffers.push_back(std::make_unique<thread_buffer>());
+        buffers.back()->tid = buffers.size();
+        return buffers.back().get();
+    }();
+    return *buffer;
+}
+
+double now_us() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+} // namespace
+
+trace_span::trace_span(const char *name, const char *arg_name, std::int64_t arg)
+    : name{name}, arg_name{arg_name}, arg{arg}, start_us{now_us()} {}
+
+trace_span::~trace_span() {
+    const auto end_us = now_us();
+    this_thread_buffer().events.push_back(trace_event{name, arg_name, arg, start_us, end_us - start_us});
+}
+
+bool write_trace(const char *path) {
+    std::ofstream out{path};
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock{buffers_mutex};
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out.precision(3);
+    out << std::fixed;
+    auto first = true;
+    for (const auto &buffer : buffers) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+        first = false;
+        for (const auto &e : buffer->events) {
+            out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"aoc\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << e.start_us << ",\"dur\":" << e.dur_us;
+            if (e.arg_name)
+                out << ",\"args\":{\"" << e.arg_name << "\":" << e.arg << '}';
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
+
+#ifdef TESTING
+TEST_CASE("trace", "[util][trace]") {
+    {
+        AOC_TRACE_SCOPE("outer");
+        AOC_TRACE_SCOPE_ARG("inner", "n", 42);
+    }
+    std::thread{[] {
+        AOC_TRACE_SCOPE("on another thread");
+    }}.join();
+
+    char path[] = "/tmp/aoc2024-trace-XXXXXX";
+    const auto fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    REQUIRE(write_trace(path));
+
+    std::ifstream in{path};
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    const auto json = contents.str();
+    CHECK(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    CHECK(json.find("\"name\":\"outer\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"inner\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"n\":42}") != std::string::npos);
+    CHECK(json.find("\"name\":\"on another thread\"") != std::string::npos);
+    std::remove(path);
+}
+#endif
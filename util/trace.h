@@ -0,0 +1,45 @@
+#include <cstdint>
+
+#pragma once
+
+// Scoped spans that are recorded as Chrome trace events, viewable in chrome://tracing or Perfetto. Only built when
+// configuring with -DAOC_TRACING=ON; otherwise the macros expand to nothing and cost nothing.
+//
+//     AOC_TRACE_SCOPE("simulate");                  // a span from here to the end of the enclosing block
+//     AOC_TRACE_SCOPE_ARG("day", "number", 7);      // the same, tagged with one integer argument
+//
+// Span names must be string literals (or otherwise outlive the program) since only the pointer is kept.
+#ifdef AOC_TRACING
+constexpr bool trace_enabled = true;
+
+class trace_span {
+    const char *name, *arg_name;
+    std::int64_t arg;
+    double start_us;
+
+public:
+    explicit trace_span(const char *name, const char *arg_name = nullptr, std::int64_t arg = 0);
+    trace_span(const trace_span &other) = delete;
+    ~trace_span();
+
+    trace_span &operator=(const trace_span &other) = delete;
+};
+
+// Writes every span recorded so far, from every thread, to path. Must not race with threads still recording spans.
+bool write_trace(const char *path);
+
+#define AOC_TRACE_CONCAT_(a, b) a##b
+#define AOC_TRACE_CONCAT(a, b) AOC_TRACE_CONCAT_(a, b)
+#define AOC_TRACE_SCOPE(name) const trace_span AOC_TRACE_CONCAT(aoc_trace_span_, __LINE__)(name)
+#define AOC_TRACE_SCOPE_ARG(name, arg_name, arg) \
+    const trace_span AOC_TRACE_CONCAT(aoc_trace_span_, __LINE__)(name, arg_name, arg)
+#else
+constexpr bool trace_enabled = false;
+
+inline bool write_trace(const char *) {
+    return false;
+}
+
+#define AOC_TRACE_SCOPE(name)
+#define AOC_TRACE_SCOPE_ARG(name, arg_name, arg)
+#endif